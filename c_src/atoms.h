@@ -67,6 +67,15 @@ extern ERL_NIF_TERM ATOM_INPLACE_UPDATE_SUPPORT;
 extern ERL_NIF_TERM ATOM_INPLACE_UPDATE_NUM_LOCKS;
 extern ERL_NIF_TERM ATOM_TABLE_FACTORY_BLOCK_CACHE_SIZE;
 extern ERL_NIF_TERM ATOM_IN_MEMORY_MODE;
+extern ERL_NIF_TERM ATOM_BLOCK_CACHE;
+extern ERL_NIF_TERM ATOM_BLOCK_CACHE_STATISTICS;
+extern ERL_NIF_TERM ATOM_MERGE_OPERATOR;
+extern ERL_NIF_TERM ATOM_UINT64_ADD;
+extern ERL_NIF_TERM ATOM_APPEND;
+extern ERL_NIF_TERM ATOM_SET_UNION;
+extern ERL_NIF_TERM ATOM_BULK_LOAD;
+extern ERL_NIF_TERM ATOM_RATE_LIMITER;
+extern ERL_NIF_TERM ATOM_CONFLICT;
 
 // Related to DBOptions
 extern ERL_NIF_TERM ATOM_TOTAL_THREADS;
@@ -103,12 +112,17 @@ extern ERL_NIF_TERM ATOM_ACCESS_HINT;
 extern ERL_NIF_TERM ATOM_USE_ADAPTIVE_MUTEX;
 extern ERL_NIF_TERM ATOM_BYTES_PER_SYNC;
 
+// Related to erocksdb per database options
+extern ERL_NIF_TERM ATOM_COALESCE_GETS;
+
 // Related to Read Options
 extern ERL_NIF_TERM ATOM_VERIFY_CHECKSUMS;
 extern ERL_NIF_TERM ATOM_FILL_CACHE;
 extern ERL_NIF_TERM ATOM_ITERATE_UPPER_BOUND;
+extern ERL_NIF_TERM ATOM_ITERATE_LOWER_BOUND;
 extern ERL_NIF_TERM ATOM_TAILING;
 extern ERL_NIF_TERM ATOM_TOTAL_ORDER_SEEK;
+extern ERL_NIF_TERM ATOM_ZERO_COPY;
 
 // Related to Write Options
 extern ERL_NIF_TERM ATOM_SYNC;
@@ -120,6 +134,7 @@ extern ERL_NIF_TERM ATOM_IGNORE_MISSING_COLUMN_FAMILIES;
 extern ERL_NIF_TERM ATOM_CLEAR;
 extern ERL_NIF_TERM ATOM_PUT;
 extern ERL_NIF_TERM ATOM_DELETE;
+extern ERL_NIF_TERM ATOM_MERGE;
 
 // Related to Iterator Actions
 extern ERL_NIF_TERM ATOM_FIRST;
@@ -157,6 +172,8 @@ extern ERL_NIF_TERM ATOM_ERROR_DB_DELETE;
 extern ERL_NIF_TERM ATOM_ERROR_DB_WRITE;
 extern ERL_NIF_TERM ATOM_ERROR_DB_DESTROY;
 extern ERL_NIF_TERM ATOM_ERROR_DB_REPAIR;
+extern ERL_NIF_TERM ATOM_ERROR_DB_BULK_LOAD;
+extern ERL_NIF_TERM ATOM_ERROR_DB_GET;
 extern ERL_NIF_TERM ATOM_BAD_WRITE_ACTION;
 extern ERL_NIF_TERM ATOM_KEEP_RESOURCE_FAILED;
 extern ERL_NIF_TERM ATOM_ITERATOR_CLOSED;
@@ -165,6 +182,39 @@ extern ERL_NIF_TERM ATOM_INVALID_ITERATOR;
 // Related to NIF initialize parameters
 extern ERL_NIF_TERM ATOM_WRITE_THREADS;
 
+// Related to cache info
+extern ERL_NIF_TERM ATOM_CAPACITY;
+extern ERL_NIF_TERM ATOM_USAGE;
+extern ERL_NIF_TERM ATOM_HITS;
+extern ERL_NIF_TERM ATOM_MISSES;
+
+// Related to noreply writes
+extern ERL_NIF_TERM ATOM_NOREPLY;
+extern ERL_NIF_TERM ATOM_WRITE_WATERMARK;
+
+// Related to delete_range
+extern ERL_NIF_TERM ATOM_COMPACT_RANGE;
+
+// Related to event notifications
+extern ERL_NIF_TERM ATOM_EVENT;
+extern ERL_NIF_TERM ATOM_FLUSH_COMPLETED;
+extern ERL_NIF_TERM ATOM_COMPACTION_COMPLETED;
+extern ERL_NIF_TERM ATOM_WRITE_STALL_BEGIN;
+extern ERL_NIF_TERM ATOM_WRITE_STALL_END;
+extern ERL_NIF_TERM ATOM_SLOWDOWN;
+extern ERL_NIF_TERM ATOM_STOP;
+
+// Related to range scans
+extern ERL_NIF_TERM ATOM_SCAN;
+extern ERL_NIF_TERM ATOM_DONE;
+extern ERL_NIF_TERM ATOM_UNDEFINED;
+extern ERL_NIF_TERM ATOM_EXACT;
+extern ERL_NIF_TERM ATOM_ESTIMATE;
+
+// Related to streaming scans
+extern ERL_NIF_TERM ATOM_STREAM;
+extern ERL_NIF_TERM ATOM_DATA;
+
 }   // namespace erocksdb
 
 
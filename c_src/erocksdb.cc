@@ -42,6 +42,11 @@
 #include "rocksdb/table.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/memtablerep.h"
+
+#ifndef INCL_MERGE_OPERATORS_H
+    #include "merge_operators.h"
+#endif
 
 #ifndef INCL_THREADING_H
     #include "threading.h"
@@ -67,13 +72,44 @@ static ErlNifFunc nif_funcs[] =
     {"destroy", 2, erocksdb_destroy},
     {"repair", 2, erocksdb_repair},
     {"is_empty", 1, erocksdb_is_empty},
+    {"key_may_exist", 3, erocksdb_key_may_exist},
+    {"keys_may_exist", 3, erocksdb_keys_may_exist},
+    {"new_cache", 2, erocksdb_new_cache},
+    {"cache_info", 1, erocksdb_cache_info},
+    {"write_watermark", 1, erocksdb_write_watermark},
+    {"subscribe_write_watermark", 1, erocksdb_subscribe_write_watermark},
+    {"unsubscribe_write_watermark", 1, erocksdb_unsubscribe_write_watermark},
+    {"subscribe_events", 1, erocksdb_subscribe_events},
+    {"unsubscribe_events", 1, erocksdb_unsubscribe_events},
+    {"new_rate_limiter", 1, erocksdb_new_rate_limiter},
+    {"set_rate_limit", 2, erocksdb_set_rate_limit},
+    {"read_options", 1, erocksdb_read_options},
+    {"write_options", 1, erocksdb_write_options},
+    {"stream_open", 6, erocksdb_stream_open},
+    {"stream_ack", 2, erocksdb_stream_ack},
+    {"stream_close", 1, erocksdb_stream_close},
+    {"batch", 0, erocksdb_batch},
+    {"batch_put", 3, erocksdb_batch_put},
+    {"batch_delete", 2, erocksdb_batch_delete},
+    {"batch_clear", 1, erocksdb_batch_clear},
+    {"batch_count", 1, erocksdb_batch_count},
+    {"batch_data_size", 1, erocksdb_batch_data_size},
 
     {"async_open", 4, erocksdb::async_open},
     {"async_write", 4, erocksdb::async_write},
+    {"async_write_batch", 4, erocksdb::async_write_batch},
+    {"async_write_packed", 4, erocksdb::async_write_packed},
+    {"async_delete_range", 5, erocksdb::async_delete_range},
+    {"async_finish_bulk_load", 2, erocksdb::async_finish_bulk_load},
+    {"async_put_if", 6, erocksdb::async_put_if},
+    {"async_split_range", 5, erocksdb::async_split_range},
+    {"async_count_range", 5, erocksdb::async_count_range},
     {"async_get", 4, erocksdb::async_get},
+    {"async_multi_get", 4, erocksdb::async_multi_get},
 
     {"async_iterator", 3, erocksdb::async_iterator},
     {"async_iterator", 4, erocksdb::async_iterator},
+    {"async_iterator_from", 3, erocksdb::async_iterator_from},
 
     {"async_iterator_move", 3, erocksdb::async_iterator_move}
 };
@@ -123,6 +159,15 @@ ERL_NIF_TERM ATOM_INPLACE_UPDATE_SUPPORT;
 ERL_NIF_TERM ATOM_INPLACE_UPDATE_NUM_LOCKS;
 ERL_NIF_TERM ATOM_TABLE_FACTORY_BLOCK_CACHE_SIZE;
 ERL_NIF_TERM ATOM_IN_MEMORY_MODE;
+ERL_NIF_TERM ATOM_BLOCK_CACHE;
+ERL_NIF_TERM ATOM_BLOCK_CACHE_STATISTICS;
+ERL_NIF_TERM ATOM_MERGE_OPERATOR;
+ERL_NIF_TERM ATOM_UINT64_ADD;
+ERL_NIF_TERM ATOM_APPEND;
+ERL_NIF_TERM ATOM_SET_UNION;
+ERL_NIF_TERM ATOM_BULK_LOAD;
+ERL_NIF_TERM ATOM_RATE_LIMITER;
+ERL_NIF_TERM ATOM_CONFLICT;
 
 // Related to DBOptions
 ERL_NIF_TERM ATOM_TOTAL_THREADS;
@@ -159,12 +204,17 @@ ERL_NIF_TERM ATOM_ACCESS_HINT;
 ERL_NIF_TERM ATOM_USE_ADAPTIVE_MUTEX;
 ERL_NIF_TERM ATOM_BYTES_PER_SYNC;
 
+// Related to erocksdb per database options
+ERL_NIF_TERM ATOM_COALESCE_GETS;
+
 // Related to Read Options
 ERL_NIF_TERM ATOM_VERIFY_CHECKSUMS;
 ERL_NIF_TERM ATOM_FILL_CACHE;
 ERL_NIF_TERM ATOM_ITERATE_UPPER_BOUND;
+ERL_NIF_TERM ATOM_ITERATE_LOWER_BOUND;
 ERL_NIF_TERM ATOM_TAILING;
 ERL_NIF_TERM ATOM_TOTAL_ORDER_SEEK;
+ERL_NIF_TERM ATOM_ZERO_COPY;
 
 // Related to Write Options
 ERL_NIF_TERM ATOM_SYNC;
@@ -176,6 +226,7 @@ ERL_NIF_TERM ATOM_IGNORE_MISSING_COLUMN_FAMILIES;
 ERL_NIF_TERM ATOM_CLEAR;
 ERL_NIF_TERM ATOM_PUT;
 ERL_NIF_TERM ATOM_DELETE;
+ERL_NIF_TERM ATOM_MERGE;
 
 // Related to Iterator Actions
 ERL_NIF_TERM ATOM_FIRST;
@@ -213,6 +264,8 @@ ERL_NIF_TERM ATOM_ERROR_DB_DELETE;
 ERL_NIF_TERM ATOM_ERROR_DB_WRITE;
 ERL_NIF_TERM ATOM_ERROR_DB_DESTROY;
 ERL_NIF_TERM ATOM_ERROR_DB_REPAIR;
+ERL_NIF_TERM ATOM_ERROR_DB_BULK_LOAD;
+ERL_NIF_TERM ATOM_ERROR_DB_GET;
 ERL_NIF_TERM ATOM_BAD_WRITE_ACTION;
 ERL_NIF_TERM ATOM_KEEP_RESOURCE_FAILED;
 ERL_NIF_TERM ATOM_ITERATOR_CLOSED;
@@ -221,6 +274,39 @@ ERL_NIF_TERM ATOM_INVALID_ITERATOR;
 // Related to NIF initialize parameters
 ERL_NIF_TERM ATOM_WRITE_THREADS;
 
+// Related to cache info
+ERL_NIF_TERM ATOM_CAPACITY;
+ERL_NIF_TERM ATOM_USAGE;
+ERL_NIF_TERM ATOM_HITS;
+ERL_NIF_TERM ATOM_MISSES;
+
+// Related to noreply writes
+ERL_NIF_TERM ATOM_NOREPLY;
+ERL_NIF_TERM ATOM_WRITE_WATERMARK;
+
+// Related to delete_range
+ERL_NIF_TERM ATOM_COMPACT_RANGE;
+
+// Related to event notifications
+ERL_NIF_TERM ATOM_EVENT;
+ERL_NIF_TERM ATOM_FLUSH_COMPLETED;
+ERL_NIF_TERM ATOM_COMPACTION_COMPLETED;
+ERL_NIF_TERM ATOM_WRITE_STALL_BEGIN;
+ERL_NIF_TERM ATOM_WRITE_STALL_END;
+ERL_NIF_TERM ATOM_SLOWDOWN;
+ERL_NIF_TERM ATOM_STOP;
+
+// Related to range scans
+ERL_NIF_TERM ATOM_SCAN;
+ERL_NIF_TERM ATOM_DONE;
+ERL_NIF_TERM ATOM_UNDEFINED;
+ERL_NIF_TERM ATOM_EXACT;
+ERL_NIF_TERM ATOM_ESTIMATE;
+
+// Related to streaming scans
+ERL_NIF_TERM ATOM_STREAM;
+ERL_NIF_TERM ATOM_DATA;
+
 }   // namespace erocksdb
 
 
@@ -328,6 +414,15 @@ ERL_NIF_TERM parse_db_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Options
             if (enif_get_int(env, option[1], &total_threads))
                 opts.IncreaseParallelism(total_threads);
         }
+        else if (option[0] == erocksdb::ATOM_RATE_LIMITER)
+        {
+            // limiter shared with every other database opened with it
+            erocksdb::RateLimiterObject * limiter_ptr;
+
+            limiter_ptr=erocksdb::RateLimiterObject::RetrieveRateLimiterObject(env, option[1]);
+            if (NULL!=limiter_ptr)
+                opts.rate_limiter = limiter_ptr->m_Limiter;
+        }
         else if (option[0] == erocksdb::ATOM_CREATE_IF_MISSING)
             opts.create_if_missing = (option[1] == erocksdb::ATOM_TRUE);
         else if (option[0] == erocksdb::ATOM_CREATE_MISSING_COLUMN_FAMILIES)
@@ -508,6 +603,21 @@ ERL_NIF_TERM parse_db_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Options
     return erocksdb::ATOM_OK;
 }
 
+ERL_NIF_TERM parse_db_object_option(ErlNifEnv* env, ERL_NIF_TERM item, erocksdb::DbObjectOptions& opts)
+{
+    int arity;
+    const ERL_NIF_TERM* option;
+    if (enif_get_tuple(env, item, &arity, &option) && 2==arity)
+    {
+        if (option[0] == erocksdb::ATOM_COALESCE_GETS)
+            opts.m_CoalesceGets = (option[1] == erocksdb::ATOM_TRUE);
+        else if (option[0] == erocksdb::ATOM_BULK_LOAD)
+            opts.m_BulkLoad = (option[1] == erocksdb::ATOM_TRUE);
+    }
+
+    return erocksdb::ATOM_OK;
+}
+
 ERL_NIF_TERM parse_cf_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Options& opts)
 {
     int arity;
@@ -711,6 +821,22 @@ ERL_NIF_TERM parse_cf_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Options
                 opts.table_factory = std::shared_ptr<rocksdb::TableFactory>(rocksdb::NewBlockBasedTableFactory(bbtOpts));
             }
         }
+        else if (option[0] == erocksdb::ATOM_MERGE_OPERATOR)
+        {
+            int op_arity;
+            const ERL_NIF_TERM* op;
+            ErlNifBinary delimiter;
+
+            if (option[1] == erocksdb::ATOM_UINT64_ADD)
+                opts.merge_operator = std::make_shared<erocksdb::UInt64AddOperator>();
+            else if (option[1] == erocksdb::ATOM_SET_UNION)
+                opts.merge_operator = std::make_shared<erocksdb::SetUnionOperator>();
+            else if (enif_get_tuple(env, option[1], &op_arity, &op) && 2==op_arity
+                     && op[0] == erocksdb::ATOM_APPEND
+                     && enif_inspect_binary(env, op[1], &delimiter))
+                opts.merge_operator = std::make_shared<erocksdb::AppendOperator>(
+                    std::string((const char *)delimiter.data, delimiter.size));
+        }
         else if (option[0] == erocksdb::ATOM_IN_MEMORY_MODE)
         {
             if (option[1] == erocksdb::ATOM_TRUE)
@@ -742,6 +868,89 @@ ERL_NIF_TERM parse_cf_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Options
     return erocksdb::ATOM_OK;
 }
  
+/**
+ * {block_cache, Cache} is applied after the other column family options,
+ *  so the shared cache replaces the private one of
+ *  table_factory_block_cache_size whatever the option order.  The rest
+ *  of that block based table setup is the same.  Returns false when
+ *  in_memory_mode asks for a plain table, which has no block cache.
+ */
+static bool
+apply_block_cache_option(ErlNifEnv* env, ERL_NIF_TERM list, rocksdb::Options& opts)
+{
+    ERL_NIF_TERM head, tail;
+    const ERL_NIF_TERM* option;
+    int arity;
+    erocksdb::CacheObject * cache_ptr(NULL);
+    bool plain_table(false), statistics(false);
+
+    tail=list;
+    while (enif_get_list_cell(env, tail, &head, &tail))
+    {
+        if (enif_get_tuple(env, head, &arity, &option) && 2==arity)
+        {
+            if (option[0] == erocksdb::ATOM_BLOCK_CACHE)
+                cache_ptr=erocksdb::CacheObject::RetrieveCacheObject(env, option[1]);
+            else if (option[0] == erocksdb::ATOM_IN_MEMORY_MODE)
+                plain_table=(option[1] == erocksdb::ATOM_TRUE);
+            else if (option[0] == erocksdb::ATOM_BLOCK_CACHE_STATISTICS)
+                statistics=(option[1] == erocksdb::ATOM_TRUE);
+        }   // if
+    }   // while
+
+    if (NULL==cache_ptr)
+        return(true);
+
+    if (plain_table)
+        return(false);
+
+    // cache shared with every other database opened with it
+    rocksdb::BlockBasedTableOptions bbtOpts;
+    bbtOpts.block_cache = cache_ptr->m_Cache;
+    bbtOpts.filter_policy = std::shared_ptr<const rocksdb::FilterPolicy>(rocksdb::NewBloomFilterPolicy(10));
+
+    opts.table_factory = std::shared_ptr<rocksdb::TableFactory>(rocksdb::NewBlockBasedTableFactory(bbtOpts));
+
+    // full rocksdb statistics cost every operation, so hit/miss
+    //  counting is opt-in.  The tickers are shared by all opted in users
+    if (statistics)
+        opts.statistics = cache_ptr->m_Statistics;
+
+    return(true);
+
+}   // apply_block_cache_option
+
+
+/**
+ * {bulk_load, true} is applied after all other options:  no compaction
+ *  or stalls until finish_bulk_load, which restores the values saved
+ *  here through SetOptions (WAL is skipped via DbObjectOptions).  The
+ *  memtable stays a skiplist, its factory cannot change without a reopen.
+ */
+static void
+apply_bulk_load_option(rocksdb::Options& opts, erocksdb::DbObjectOptions& object_opts)
+{
+    if (!object_opts.m_BulkLoad)
+        return;
+
+    object_opts.m_BulkLoadRestore["disable_auto_compactions"]=
+        opts.disable_auto_compactions ? "true" : "false";
+    object_opts.m_BulkLoadRestore["level0_file_num_compaction_trigger"]=
+        std::to_string(opts.level0_file_num_compaction_trigger);
+    object_opts.m_BulkLoadRestore["level0_slowdown_writes_trigger"]=
+        std::to_string(opts.level0_slowdown_writes_trigger);
+    object_opts.m_BulkLoadRestore["level0_stop_writes_trigger"]=
+        std::to_string(opts.level0_stop_writes_trigger);
+
+    opts.disable_auto_compactions = true;
+    opts.level0_file_num_compaction_trigger = (1<<30);
+    opts.level0_slowdown_writes_trigger = (1<<30);
+    opts.level0_stop_writes_trigger = (1<<30);
+
+    return;
+
+}   // apply_bulk_load_option
+
 ERL_NIF_TERM parse_read_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::ReadOptions& opts)
 {
     int arity;
@@ -752,9 +961,6 @@ ERL_NIF_TERM parse_read_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::ReadO
             opts.verify_checksums = (option[1] == erocksdb::ATOM_TRUE);
         else if (option[0] == erocksdb::ATOM_FILL_CACHE)
             opts.fill_cache = (option[1] == erocksdb::ATOM_TRUE);
-        else if (option[0] == erocksdb::ATOM_ITERATE_UPPER_BOUND)
-            // @TODO Who should be the Slice owner?
-            ;
         else if (option[0] == erocksdb::ATOM_TAILING)
             opts.tailing = (option[1] == erocksdb::ATOM_TRUE);
         else if (option[0] == erocksdb::ATOM_TOTAL_ORDER_SEEK)
@@ -764,6 +970,77 @@ ERL_NIF_TERM parse_read_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::ReadO
     return erocksdb::ATOM_OK;
 }
 
+/** iterate_upper_bound is a pointer in rocksdb::ReadOptions, the bytes
+ *   must live as long as the iterator.  Bounds are collected here and
+ *   owned by the iterator's RocksIteratorWrapper
+ */
+ERL_NIF_TERM parse_iterate_bound_option(ErlNifEnv* env, ERL_NIF_TERM item, erocksdb::IterateBounds& bounds)
+{
+    int arity;
+    const ERL_NIF_TERM* option;
+    if (enif_get_tuple(env, item, &arity, &option) && 2==arity)
+    {
+        ErlNifBinary key;
+
+        if (option[0] == erocksdb::ATOM_ITERATE_UPPER_BOUND
+            && enif_inspect_binary(env, option[1], &key))
+        {
+            bounds.m_Upper.assign((const char *)key.data, key.size);
+            bounds.m_HasUpper = true;
+        }
+        else if (option[0] == erocksdb::ATOM_ITERATE_LOWER_BOUND
+                 && enif_inspect_binary(env, option[1], &key))
+        {
+            bounds.m_Lower.assign((const char *)key.data, key.size);
+            bounds.m_HasLower = true;
+        }
+    }
+
+    return erocksdb::ATOM_OK;
+}
+
+/** zero_copy is not a rocksdb::ReadOptions member, it selects how
+ *   get results are handed back to erlang
+ */
+ERL_NIF_TERM parse_zero_copy_option(ErlNifEnv* env, ERL_NIF_TERM item, bool& zero_copy)
+{
+    int arity;
+    const ERL_NIF_TERM* option;
+    if (enif_get_tuple(env, item, &arity, &option) && 2==arity)
+    {
+        if (option[0] == erocksdb::ATOM_ZERO_COPY)
+            zero_copy = (option[1] == erocksdb::ATOM_TRUE);
+    }
+
+    return erocksdb::ATOM_OK;
+}
+
+ERL_NIF_TERM parse_noreply_option(ErlNifEnv* env, ERL_NIF_TERM item, bool& noreply)
+{
+    int arity;
+    const ERL_NIF_TERM* option;
+    if (enif_get_tuple(env, item, &arity, &option) && 2==arity)
+    {
+        if (option[0] == erocksdb::ATOM_NOREPLY)
+            noreply = (option[1] == erocksdb::ATOM_TRUE);
+    }
+
+    return erocksdb::ATOM_OK;
+}
+
+ERL_NIF_TERM parse_compact_range_option(ErlNifEnv* env, ERL_NIF_TERM item, bool& compact)
+{
+    int arity;
+    const ERL_NIF_TERM* option;
+    if (enif_get_tuple(env, item, &arity, &option) && 2==arity)
+    {
+        if (option[0] == erocksdb::ATOM_COMPACT_RANGE)
+            compact = (option[1] == erocksdb::ATOM_TRUE);
+    }
+
+    return erocksdb::ATOM_OK;
+}
+
 ERL_NIF_TERM parse_write_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::WriteOptions& opts)
 {
     int arity;
@@ -787,6 +1064,79 @@ ERL_NIF_TERM parse_write_option(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::Writ
     return erocksdb::ATOM_OK;
 }
 
+/**
+ * Options argument of read and write calls is either a list, parsed
+ *  on every call, or a handle from read_options/write_options that
+ *  was parsed once and is only copied here
+ */
+static bool
+is_read_options(ErlNifEnv* env, ERL_NIF_TERM opts_ref)
+{
+    return(enif_is_list(env, opts_ref)
+           || NULL!=erocksdb::ReadOptionsObject::RetrieveReadOptionsObject(env, opts_ref));
+}
+
+static void
+get_read_options(ErlNifEnv* env, ERL_NIF_TERM opts_ref, rocksdb::ReadOptions& opts, bool& zero_copy)
+{
+    erocksdb::ReadOptionsObject * opts_ptr;
+
+    opts_ptr=erocksdb::ReadOptionsObject::RetrieveReadOptionsObject(env, opts_ref);
+
+    if (NULL!=opts_ptr)
+    {
+        opts=opts_ptr->m_Options;
+        zero_copy=opts_ptr->m_ZeroCopy;
+    }   // if
+    else
+    {
+        fold(env, opts_ref, parse_read_option, opts);
+        fold(env, opts_ref, parse_zero_copy_option, zero_copy);
+    }   // else
+}
+
+static void
+get_iterate_bounds(ErlNifEnv* env, ERL_NIF_TERM opts_ref, erocksdb::IterateBounds& bounds)
+{
+    erocksdb::ReadOptionsObject * opts_ptr;
+
+    opts_ptr=erocksdb::ReadOptionsObject::RetrieveReadOptionsObject(env, opts_ref);
+
+    if (NULL!=opts_ptr)
+        bounds=opts_ptr->m_Bounds;
+    else
+        fold(env, opts_ref, parse_iterate_bound_option, bounds);
+}
+
+static bool
+is_write_options(ErlNifEnv* env, ERL_NIF_TERM opts_ref)
+{
+    return(enif_is_list(env, opts_ref)
+           || NULL!=erocksdb::WriteOptionsObject::RetrieveWriteOptionsObject(env, opts_ref));
+}
+
+static void
+get_write_options(ErlNifEnv* env, ERL_NIF_TERM opts_ref, rocksdb::WriteOptions& opts,
+                  bool& noreply, bool& compact)
+{
+    erocksdb::WriteOptionsObject * opts_ptr;
+
+    opts_ptr=erocksdb::WriteOptionsObject::RetrieveWriteOptionsObject(env, opts_ref);
+
+    if (NULL!=opts_ptr)
+    {
+        opts=opts_ptr->m_Options;
+        noreply=opts_ptr->m_NoReply;
+        compact=opts_ptr->m_CompactRange;
+    }   // if
+    else
+    {
+        fold(env, opts_ref, parse_write_option, opts);
+        fold(env, opts_ref, parse_noreply_option, noreply);
+        fold(env, opts_ref, parse_compact_range_option, compact);
+    }   // else
+}
+
 ERL_NIF_TERM write_batch_item(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::WriteBatch& batch)
 {
     int arity;
@@ -812,6 +1162,16 @@ ERL_NIF_TERM write_batch_item(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::WriteB
             return erocksdb::ATOM_OK;
         }
 
+        if (action[0] == erocksdb::ATOM_MERGE && arity == 3 &&
+            enif_inspect_binary(env, action[1], &key) &&
+            enif_inspect_binary(env, action[2], &value))
+        {
+            rocksdb::Slice key_slice((const char*)key.data, key.size);
+            rocksdb::Slice value_slice((const char*)value.data, value.size);
+            batch.Merge(key_slice, value_slice);
+            return erocksdb::ATOM_OK;
+        }
+
         if (action[0] == erocksdb::ATOM_DELETE && arity == 2 &&
             enif_inspect_binary(env, action[1], &key))
         {
@@ -821,11 +1181,103 @@ ERL_NIF_TERM write_batch_item(ErlNifEnv* env, ERL_NIF_TERM item, rocksdb::WriteB
         }
     }
 
-    // Failed to match clear/put/delete; return the failing item
+    // Failed to match clear/put/merge/delete; return the failing item
     return item;
 }
 
 
+/**
+ * rocksdb 3.11 accepts merges without a merge operator and fails
+ *  only on read or in compaction, where the background error makes
+ *  the database read-only.  True if Actions holds a merge.
+ */
+static bool
+has_merge_action(
+    ErlNifEnv* env,
+    ERL_NIF_TERM Actions)
+{
+    ERL_NIF_TERM head, tail;
+    const ERL_NIF_TERM* action;
+    int arity;
+
+    tail=Actions;
+    while (enif_get_list_cell(env, tail, &head, &tail))
+    {
+        if (enif_get_tuple(env, head, &arity, &action) && 0<arity
+            && action[0] == erocksdb::ATOM_MERGE)
+            return(true);
+    }   // while
+
+    return(false);
+
+}   // has_merge_action
+
+
+
+/**
+ * Decode a packed write batch:  a sequence of records
+ *  <<1, KeyLen:32/big, Key, ValueLen:32/big, Value>> (put) and
+ *  <<0, KeyLen:32/big, Key>> (delete).  Returns false on any
+ *  malformed or truncated record.
+ */
+static bool
+decode_packed_batch(
+    const unsigned char * Data,
+    size_t Size,
+    rocksdb::WriteBatch & Batch)
+{
+    const unsigned char * cursor, * end;
+    uint32_t key_len, value_len;
+    unsigned char type;
+
+    cursor=Data;
+    end=Data+Size;
+
+    while (cursor<end)
+    {
+        if ((size_t)(end-cursor)<5)
+            return(false);
+
+        type=*cursor;
+        key_len=((uint32_t)cursor[1]<<24) | ((uint32_t)cursor[2]<<16)
+            | ((uint32_t)cursor[3]<<8) | (uint32_t)cursor[4];
+        cursor+=5;
+
+        if ((size_t)(end-cursor)<key_len)
+            return(false);
+
+        rocksdb::Slice key_slice((const char *)cursor, key_len);
+        cursor+=key_len;
+
+        if (1==type)
+        {
+            if ((size_t)(end-cursor)<4)
+                return(false);
+
+            value_len=((uint32_t)cursor[0]<<24) | ((uint32_t)cursor[1]<<16)
+                | ((uint32_t)cursor[2]<<8) | (uint32_t)cursor[3];
+            cursor+=4;
+
+            if ((size_t)(end-cursor)<value_len)
+                return(false);
+
+            Batch.Put(key_slice, rocksdb::Slice((const char *)cursor, value_len));
+            cursor+=value_len;
+        }   // if
+        else if (0==type)
+        {
+            Batch.Delete(key_slice);
+        }   // else if
+        else
+        {
+            return(false);
+        }   // else
+    }   // while
+
+    return(true);
+
+}   // decode_packed_batch
+
 
 namespace erocksdb {
 
@@ -865,8 +1317,23 @@ async_open(
     fold(env, argv[2], parse_db_option, *opts);
     fold(env, argv[3], parse_cf_option, *opts);
 
+    if (!apply_block_cache_option(env, argv[3], *opts))
+    {
+        delete opts;
+        return enif_make_badarg(env);
+    }   // if
+
+    erocksdb::DbObjectOptions object_opts;
+    fold(env, argv[2], parse_db_object_option, object_opts);
+    fold(env, argv[3], parse_db_object_option, object_opts);
+    apply_bulk_load_option(*opts, object_opts);
+
+    // always installed, idle until someone subscribes
+    object_opts.m_EventListener = std::make_shared<erocksdb::ErlangEventListener>();
+    opts->listeners.push_back(object_opts.m_EventListener);
+
     erocksdb::WorkTask *work_item = new erocksdb::OpenTask(env, caller_ref,
-                                                              db_name, opts);
+                                                              db_name, opts, object_opts);
 
     if(false == priv.thread_pool.submit(work_item))
     {
@@ -880,6 +1347,51 @@ async_open(
 }   // async_open
 
 
+/**
+ * Queue a WriteTask.  noreply:  returns {ok, Ticket} now and the
+ *  write completes through the watermark, otherwise ok and the
+ *  caller waits for the reply message.
+ */
+static ERL_NIF_TERM
+submit_write_task(
+    ErlNifEnv* env,
+    DbObject * db_ptr,
+    const ERL_NIF_TERM & caller_ref,
+    erocksdb::WriteTask * work_item,
+    bool noreply)
+{
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+    uint64_t ticket = 0;
+
+    if (noreply)
+    {
+        ticket = db_ptr->IssueNoReplyTicket();
+        work_item->SetNoReplyTicket(ticket);
+    }   // if
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+
+        if (noreply)
+        {
+            // never leave a gap below the watermark
+            db_ptr->CompleteNoReplyWrite(ticket, false);
+            return enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref);
+        }   // if
+
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    if (noreply)
+        return enif_make_tuple2(env, erocksdb::ATOM_OK, enif_make_uint64(env, ticket));
+
+    return erocksdb::ATOM_OK;
+
+}   // submit_write_task
+
+
 ERL_NIF_TERM
 async_write(
     ErlNifEnv* env,
@@ -897,7 +1409,7 @@ async_write(
 
     if(NULL==db_ptr.get()
        || !enif_is_list(env, action_ref)
-       || !enif_is_list(env, opts_ref))
+       || !is_write_options(env, opts_ref))
     {
         return enif_make_badarg(env);
     }
@@ -906,500 +1418,1919 @@ async_write(
     if(NULL == db_ptr->m_Db)
         return send_reply(env, caller_ref, error_einval(env));
 
-    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+    if(!db_ptr->m_DbOptions->merge_operator && has_merge_action(env, action_ref))
+        return enif_make_badarg(env);
 
     // Construct a write batch:
     rocksdb::WriteBatch* batch = new rocksdb::WriteBatch;
 
+    // noreply:  caller gets a watermark ticket now, no message later
+    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
+    bool noreply = false, compact = false;
+    get_write_options(env, opts_ref, *opts, noreply, compact);
+
     // Seed the batch's data:
     ERL_NIF_TERM result = fold(env, argv[2], write_batch_item, *batch);
     if(erocksdb::ATOM_OK != result)
     {
+        delete batch;
+        delete opts;
+
+        if (noreply)
+            return enif_make_tuple2(env, erocksdb::ATOM_ERROR,
+                                    enif_make_tuple2(env, erocksdb::ATOM_BAD_WRITE_ACTION,
+                                                     result));
+
         return send_reply(env, caller_ref,
                           enif_make_tuple3(env, erocksdb::ATOM_ERROR, caller_ref,
                                            enif_make_tuple2(env, erocksdb::ATOM_BAD_WRITE_ACTION,
                                                             result)));
     }   // if
 
-    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
-    fold(env, argv[3], parse_write_option, *opts);
-
-    erocksdb::WorkTask* work_item = new erocksdb::WriteTask(env, caller_ref,
-                                                            db_ptr.get(), batch, opts);
-
-    if(false == priv.thread_pool.submit(work_item))
-    {
-        delete work_item;
-        return send_reply(env, caller_ref,
-                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
-    }   // if
+    erocksdb::WriteTask* work_item = new erocksdb::WriteTask(env, caller_ref,
+                                                             db_ptr.get(), batch, opts);
 
-    return erocksdb::ATOM_OK;
+    return submit_write_task(env, db_ptr.get(), caller_ref, work_item, noreply);
 }
 
 
 ERL_NIF_TERM
-async_get(
+async_write_batch(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
     const ERL_NIF_TERM& caller_ref = argv[0];
-    const ERL_NIF_TERM& dbh_ref    = argv[1];
-    const ERL_NIF_TERM& key_ref    = argv[2];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+    const ERL_NIF_TERM& batch_ref  = argv[2];
     const ERL_NIF_TERM& opts_ref   = argv[3];
 
     ReferencePtr<DbObject> db_ptr;
+    BatchObject * batch_ptr;
 
-    db_ptr.assign(DbObject::RetrieveDbObject(env, dbh_ref));
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+    batch_ptr=BatchObject::RetrieveBatchObject(env, batch_ref);
 
     if(NULL==db_ptr.get()
-       || !enif_is_list(env, opts_ref)
-       || !enif_is_binary(env, key_ref))
+       || NULL==batch_ptr
+       || !is_write_options(env, opts_ref))
     {
         return enif_make_badarg(env);
     }
 
+    // is this even possible?
     if(NULL == db_ptr->m_Db)
         return send_reply(env, caller_ref, error_einval(env));
 
-    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions();
-    fold(env, opts_ref, parse_read_option, *opts);
-
-    erocksdb::WorkTask *work_item = new erocksdb::GetTask(env, caller_ref,
-                                                          db_ptr.get(), key_ref, opts);
-
-    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
+    bool noreply = false, compact = false;
+    get_write_options(env, opts_ref, *opts, noreply, compact);
 
-    if(false == priv.thread_pool.submit(work_item))
+    // compact_range only applies to delete_range
+    if (compact)
     {
-        delete work_item;
-        return send_reply(env, caller_ref,
-                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+        delete opts;
+        return enif_make_badarg(env);
     }   // if
 
-    return erocksdb::ATOM_OK;
+    // copy of the encoded batch, the resource stays usable by its owner
+    rocksdb::WriteBatch* batch;
+    {
+        MutexLock lock(batch_ptr->m_BatchMutex);
+        batch = new rocksdb::WriteBatch(batch_ptr->m_Batch);
+    }
 
-}   // async_get
+    erocksdb::WriteTask* work_item = new erocksdb::WriteTask(env, caller_ref,
+                                                             db_ptr.get(), batch, opts);
 
+    return submit_write_task(env, db_ptr.get(), caller_ref, work_item, noreply);
+
+}   // async_write_batch
 
 ERL_NIF_TERM
-async_iterator(
+async_write_packed(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    const ERL_NIF_TERM& caller_ref  = argv[0];
-    const ERL_NIF_TERM& dbh_ref     = argv[1];
-    const ERL_NIF_TERM& options_ref = argv[2];
-
-    const bool keys_only = ((argc == 4) && (argv[3] == ATOM_KEYS_ONLY));
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+    const ERL_NIF_TERM& packed_ref = argv[2];
+    const ERL_NIF_TERM& opts_ref   = argv[3];
 
     ReferencePtr<DbObject> db_ptr;
+    ErlNifBinary packed;
 
-    db_ptr.assign(DbObject::RetrieveDbObject(env, dbh_ref));
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
 
     if(NULL==db_ptr.get()
-       || !enif_is_list(env, options_ref))
-     {
+       || !enif_inspect_binary(env, packed_ref, &packed)
+       || !is_write_options(env, opts_ref))
+    {
         return enif_make_badarg(env);
-     }
+    }
 
-    // likely useless
+    // is this even possible?
     if(NULL == db_ptr->m_Db)
         return send_reply(env, caller_ref, error_einval(env));
 
-    // Parse out the read options
-    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions;
-    fold(env, options_ref, parse_read_option, *opts);
+    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
+    bool noreply = false, compact = false;
+    get_write_options(env, opts_ref, *opts, noreply, compact);
 
-    erocksdb::WorkTask *work_item = new erocksdb::IterTask(env, caller_ref,
-                                                           db_ptr.get(), keys_only, opts);
+    // compact_range only applies to delete_range
+    if (compact)
+    {
+        delete opts;
+        return enif_make_badarg(env);
+    }   // if
+
+    // encoded size is a close upper bound of the batch representation
+    rocksdb::WriteBatch* batch = new rocksdb::WriteBatch(packed.size);
+
+    if (!decode_packed_batch(packed.data, packed.size, *batch))
+    {
+        delete batch;
+        delete opts;
+        return enif_make_badarg(env);
+    }   // if
+
+    erocksdb::WriteTask* work_item = new erocksdb::WriteTask(env, caller_ref,
+                                                             db_ptr.get(), batch, opts);
+
+    return submit_write_task(env, db_ptr.get(), caller_ref, work_item, noreply);
+
+}   // async_write_packed
+
+ERL_NIF_TERM
+async_delete_range(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+    const ERL_NIF_TERM& start_ref  = argv[2];
+    const ERL_NIF_TERM& end_ref    = argv[3];
+    const ERL_NIF_TERM& opts_ref   = argv[4];
+
+    ReferencePtr<DbObject> db_ptr;
+    ErlNifBinary start, end;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+
+    if(NULL==db_ptr.get()
+       || !enif_inspect_binary(env, start_ref, &start)
+       || !enif_inspect_binary(env, end_ref, &end)
+       || !is_write_options(env, opts_ref))
+    {
+        return enif_make_badarg(env);
+    }
+
+    // is this even possible?
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
 
-    // Now-boilerplate setup (we'll consolidate this pattern soon, I hope):
     erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
 
+    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
+    bool noreply = false, compact = false;
+    get_write_options(env, opts_ref, *opts, noreply, compact);
+
+    erocksdb::WorkTask* work_item = new erocksdb::DeleteRangeTask(env, caller_ref, db_ptr.get(),
+                                                                  rocksdb::Slice((const char*)start.data, start.size),
+                                                                  rocksdb::Slice((const char*)end.data, end.size),
+                                                                  opts, compact);
+
     if(false == priv.thread_pool.submit(work_item))
     {
         delete work_item;
-        return send_reply(env, caller_ref, enif_make_tuple2(env, ATOM_ERROR, caller_ref));
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
     }   // if
 
-    return ATOM_OK;
+    return erocksdb::ATOM_OK;
 
-}   // async_iterator
+}   // async_delete_range
+
+ERL_NIF_TERM
+async_finish_bulk_load(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+
+    ReferencePtr<DbObject> db_ptr;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+
+    if(NULL==db_ptr.get())
+    {
+        return enif_make_badarg(env);
+    }
+
+    // is this even possible?
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    erocksdb::WorkTask* work_item = new erocksdb::FinishBulkLoadTask(env, caller_ref, db_ptr.get());
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_finish_bulk_load
 
 
 ERL_NIF_TERM
-async_iterator_move(
+async_put_if(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    // const ERL_NIF_TERM& caller_ref       = argv[0];
-    const ERL_NIF_TERM& itr_handle_ref   = argv[1];
-    const ERL_NIF_TERM& action_or_target = argv[2];
-    ERL_NIF_TERM ret_term;
+    const ERL_NIF_TERM& caller_ref   = argv[0];
+    const ERL_NIF_TERM& handle_ref   = argv[1];
+    const ERL_NIF_TERM& key_ref      = argv[2];
+    const ERL_NIF_TERM& expected_ref = argv[3];
+    const ERL_NIF_TERM& value_ref    = argv[4];
+    const ERL_NIF_TERM& opts_ref     = argv[5];
 
-    bool submit_new_request(true);
+    ReferencePtr<DbObject> db_ptr;
+    ErlNifBinary key, expected, value;
+    bool expect_not_found;
 
-    ReferencePtr<ItrObject> itr_ptr;
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+    expect_not_found=(expected_ref == erocksdb::ATOM_NOT_FOUND);
 
-    itr_ptr.assign(ItrObject::RetrieveItrObject(env, itr_handle_ref));
+    if(NULL==db_ptr.get()
+       || !enif_inspect_binary(env, key_ref, &key)
+       || (!expect_not_found && !enif_inspect_binary(env, expected_ref, &expected))
+       || !enif_inspect_binary(env, value_ref, &value)
+       || !is_write_options(env, opts_ref))
+    {
+        return enif_make_badarg(env);
+    }
 
-    if(NULL==itr_ptr.get())
+    // is this even possible?
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    rocksdb::WriteOptions* opts = new rocksdb::WriteOptions;
+    bool noreply = false, compact = false;
+    get_write_options(env, opts_ref, *opts, noreply, compact);
+
+    rocksdb::Slice expected_slice;
+    if (!expect_not_found)
+        expected_slice=rocksdb::Slice((const char*)expected.data, expected.size);
+
+    erocksdb::WorkTask* work_item = new erocksdb::PutIfTask(env, caller_ref, db_ptr.get(),
+                                                            rocksdb::Slice((const char*)key.data, key.size),
+                                                            expect_not_found ? NULL : &expected_slice,
+                                                            rocksdb::Slice((const char*)value.data, value.size),
+                                                            opts);
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_put_if
+
+
+ERL_NIF_TERM
+async_split_range(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+    const ERL_NIF_TERM& start_ref  = argv[2];
+    const ERL_NIF_TERM& end_ref    = argv[3];
+    const ERL_NIF_TERM& shards_ref = argv[4];
+
+    ReferencePtr<DbObject> db_ptr;
+    ErlNifBinary start, end;
+    bool has_end;
+    unsigned shards;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+    has_end=(ATOM_UNDEFINED != end_ref);
+
+    if(NULL==db_ptr.get()
+       || !enif_inspect_binary(env, start_ref, &start)
+       || (has_end && !enif_inspect_binary(env, end_ref, &end))
+       || !enif_get_uint(env, shards_ref, &shards) || 0==shards)
+    {
         return enif_make_badarg(env);
+    }
 
-    // Reuse ref from iterator creation
-    const ERL_NIF_TERM& caller_ref = itr_ptr->m_Snapshot->itr_ref;
+    // is this even possible?
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
 
-    /* We can be invoked with two different arities from Erlang. If our "action_atom" parameter is not
-       in fact an atom, then it is actually a seek target. Let's find out which we are: */
-    erocksdb::MoveTask::action_t action = erocksdb::MoveTask::SEEK;
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
 
-    // If we have an atom, it's one of these (action_or_target's value is ignored):
-    if(enif_is_atom(env, action_or_target))
+    rocksdb::Slice end_slice;
+    if (has_end)
+        end_slice=rocksdb::Slice((const char*)end.data, end.size);
+
+    erocksdb::WorkTask* work_item = new erocksdb::SplitRangeTask(env, caller_ref, db_ptr.get(),
+                                                                 rocksdb::Slice((const char*)start.data, start.size),
+                                                                 has_end ? &end_slice : NULL,
+                                                                 shards);
+
+    if(false == priv.thread_pool.submit(work_item))
     {
-        if(ATOM_FIRST == action_or_target)  action = erocksdb::MoveTask::FIRST;
-        if(ATOM_LAST == action_or_target)   action = erocksdb::MoveTask::LAST;
-        if(ATOM_NEXT == action_or_target)   action = erocksdb::MoveTask::NEXT;
-        if(ATOM_PREV == action_or_target)   action = erocksdb::MoveTask::PREV;
-        // if(ATOM_PREFETCH == action_or_target)   action = erocksdb::MoveTask::PREFETCH;
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_split_range
+
+
+ERL_NIF_TERM
+async_count_range(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& handle_ref = argv[1];
+    const ERL_NIF_TERM& start_ref  = argv[2];
+    const ERL_NIF_TERM& end_ref    = argv[3];
+    const ERL_NIF_TERM& mode_ref   = argv[4];
+
+    ReferencePtr<DbObject> db_ptr;
+    ErlNifBinary start, end;
+    bool has_end;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, handle_ref));
+    has_end=(ATOM_UNDEFINED != end_ref);
+
+    if(NULL==db_ptr.get()
+       || !enif_inspect_binary(env, start_ref, &start)
+       || (has_end && !enif_inspect_binary(env, end_ref, &end))
+       || (ATOM_EXACT != mode_ref && ATOM_ESTIMATE != mode_ref))
+    {
+        return enif_make_badarg(env);
+    }
+
+    // is this even possible?
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    rocksdb::Slice end_slice;
+    if (has_end)
+        end_slice=rocksdb::Slice((const char*)end.data, end.size);
+
+    erocksdb::WorkTask* work_item = new erocksdb::CountRangeTask(env, caller_ref, db_ptr.get(),
+                                                                 rocksdb::Slice((const char*)start.data, start.size),
+                                                                 has_end ? &end_slice : NULL,
+                                                                 ATOM_EXACT == mode_ref);
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_count_range
+
+
+/**
+ * Attempt get without disk I/O.  Returns true and sets Result to
+ *  {ok, Value} or not_found if the lookup completed from memtable
+ *  and block cache, false if a worker thread must perform it.
+ */
+static bool
+cache_tier_get(
+    ErlNifEnv* env,
+    DbObject * DbPtr,
+    const ERL_NIF_TERM & KeyRef,
+    rocksdb::ReadOptions & Options,
+    bool ZeroCopy,
+    ERL_NIF_TERM & Result)
+{
+    ErlNifBinary key;
+    rocksdb::Status status;
+    rocksdb::ReadTier old_tier;
+
+    if (!enif_inspect_binary(env, KeyRef, &key))
+        return(false);
+
+    rocksdb::Slice key_slice((const char*)key.data, key.size);
+
+    old_tier=Options.read_tier;
+    Options.read_tier=rocksdb::kBlockCacheTier;
+
+    if (ZeroCopy)
+    {
+        ValueObject * value_ptr=ValueObject::CreateValueObject();
+
+        status=DbPtr->m_Db->Get(Options, key_slice, &value_ptr->m_Value);
+
+        if (status.ok())
+            Result=enif_make_tuple2(env, ATOM_OK, value_ptr->MakeBinary(env));
+        else
+            enif_release_resource(value_ptr);
+    }   // if
+    else
+    {
+        std::string value;
+
+        status=DbPtr->m_Db->Get(Options, key_slice, &value);
+
+        if (status.ok())
+            Result=enif_make_tuple2(env, ATOM_OK, slice_to_binary(env, value));
+    }   // else
+
+    Options.read_tier=old_tier;
+
+    if (status.IsIncomplete())
+        return(false);
+
+    // same mapping as GetTask:  any other failure is not_found
+    if (!status.ok())
+        Result=ATOM_NOT_FOUND;
+
+    return(true);
+
+}   // cache_tier_get
+
+
+ERL_NIF_TERM
+async_get(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& dbh_ref    = argv[1];
+    const ERL_NIF_TERM& key_ref    = argv[2];
+    const ERL_NIF_TERM& opts_ref   = argv[3];
+
+    ReferencePtr<DbObject> db_ptr;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, dbh_ref));
+
+    if(NULL==db_ptr.get()
+       || !is_read_options(env, opts_ref)
+       || !enif_is_binary(env, key_ref))
+    {
+        return enif_make_badarg(env);
+    }
+
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions();
+    bool zero_copy(false);
+    get_read_options(env, opts_ref, *opts, zero_copy);
+
+    // fast path:  try memtable and block cache inline on the scheduler.
+    //  kBlockCacheTier forbids disk I/O so scheduler time stays bounded,
+    //  Incomplete means the lookup needs I/O and goes to a worker thread
+    ERL_NIF_TERM fast_result;
+    if (cache_tier_get(env, db_ptr.get(), key_ref, *opts, zero_copy, fast_result))
+    {
+        delete opts;
+        return fast_result;
     }   // if
 
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    // single flight:  attach to a queued GetTask for the same key and
+    //  read options or become the task others attach to
+    if (db_ptr->m_ObjectOptions.m_CoalesceGets && NULL==opts->snapshot)
+    {
+        ErlNifBinary key;
+        enif_inspect_binary(env, key_ref, &key);
+        std::string key_str(GetTask::InFlightKey(*opts, zero_copy,
+                                                 rocksdb::Slice((const char *)key.data, key.size)));
+
+        GetTask *get_item;
+
+        {
+            MutexLock lock(db_ptr->m_InFlightMutex);
+            std::map<std::string, GetTask *>::iterator it;
+
+            it=db_ptr->m_InFlightGets.find(key_str);
+            if (db_ptr->m_InFlightGets.end()!=it)
+            {
+                it->second->AddWaiter(env, caller_ref);
+                ++db_ptr->m_CoalescedGets;
+                delete opts;
+                return erocksdb::ATOM_OK;
+            }   // if
+
+            get_item = new erocksdb::GetTask(env, caller_ref,
+                                             db_ptr.get(), key_ref, opts,
+                                             zero_copy, true);
+
+            // task removes itself under the same lock once it starts
+            db_ptr->m_InFlightGets[key_str]=get_item;
+        }
+
+        // submit() takes the pool lock, keep it outside m_InFlightMutex
+        //  so gets on this db do not serialize behind it
+        if(false == priv.thread_pool.submit(get_item))
+        {
+            size_t waiters;
+
+            // never ran, so still registered:  unregister to freeze
+            //  m_Waiters, then fail everyone who attached meanwhile
+            {
+                MutexLock lock(db_ptr->m_InFlightMutex);
+                std::map<std::string, GetTask *>::iterator it;
+
+                it=db_ptr->m_InFlightGets.find(key_str);
+                if (db_ptr->m_InFlightGets.end()!=it && get_item==it->second)
+                    db_ptr->m_InFlightGets.erase(it);
+                waiters=get_item->WaiterCount();
+                db_ptr->m_CoalescedGets-=waiters;
+            }
+
+            if (0!=waiters)
+                get_item->NotifyWaiters(erocksdb::ATOM_ERROR);
+            delete get_item;
+            return send_reply(env, caller_ref,
+                              enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+        }   // if
+
+        return erocksdb::ATOM_OK;
+    }   // if
+
+    erocksdb::WorkTask *work_item = new erocksdb::GetTask(env, caller_ref,
+                                                          db_ptr.get(), key_ref, opts,
+                                                          zero_copy);
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_get
+
+
+ERL_NIF_TERM
+async_multi_get(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref = argv[0];
+    const ERL_NIF_TERM& dbh_ref    = argv[1];
+    const ERL_NIF_TERM& keys_ref   = argv[2];
+    const ERL_NIF_TERM& opts_ref   = argv[3];
+
+    ReferencePtr<DbObject> db_ptr;
+    ERL_NIF_TERM head, tail;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, dbh_ref));
+
+    if(NULL==db_ptr.get()
+       || !is_read_options(env, opts_ref)
+       || !enif_is_list(env, keys_ref))
+    {
+        return enif_make_badarg(env);
+    }
+
+    // every key must be a binary
+    tail=keys_ref;
+    while (enif_get_list_cell(env, tail, &head, &tail))
+    {
+        if (!enif_is_binary(env, head))
+            return enif_make_badarg(env);
+    }   // while
+
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions();
+    bool zero_copy(false);
+    get_read_options(env, opts_ref, *opts, zero_copy);
+
+    erocksdb::WorkTask *work_item = new erocksdb::MultiGetTask(env, caller_ref,
+                                                               db_ptr.get(), keys_ref, opts,
+                                                               zero_copy);
+
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref,
+                          enif_make_tuple2(env, erocksdb::ATOM_ERROR, caller_ref));
+    }   // if
+
+    return erocksdb::ATOM_OK;
+
+}   // async_multi_get
+
+
+ERL_NIF_TERM
+async_iterator(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref  = argv[0];
+    const ERL_NIF_TERM& dbh_ref     = argv[1];
+    const ERL_NIF_TERM& options_ref = argv[2];
+
+    const bool keys_only = ((argc == 4) && (argv[3] == ATOM_KEYS_ONLY));
+
+    ReferencePtr<DbObject> db_ptr;
+
+    db_ptr.assign(DbObject::RetrieveDbObject(env, dbh_ref));
+
+    if(NULL==db_ptr.get()
+       || !is_read_options(env, options_ref))
+     {
+        return enif_make_badarg(env);
+     }
+
+    // likely useless
+    if(NULL == db_ptr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    // Parse out the read options
+    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions;
+    bool zero_copy(false);
+    get_read_options(env, options_ref, *opts, zero_copy);
+
+    erocksdb::IterateBounds bounds;
+    get_iterate_bounds(env, options_ref, bounds);
+
+    erocksdb::WorkTask *work_item = new erocksdb::IterTask(env, caller_ref,
+                                                           db_ptr.get(), keys_only, opts,
+                                                           bounds);
+
+    // Now-boilerplate setup (we'll consolidate this pattern soon, I hope):
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref, enif_make_tuple2(env, ATOM_ERROR, caller_ref));
+    }   // if
+
+    return ATOM_OK;
+
+}   // async_iterator
+
+
+/**
+ * New iterator on the database and snapshot of an open iterator,
+ *  keys_only is inherited.  Used by parallel scans so every shard
+ *  reads the same point in time.
+ */
+ERL_NIF_TERM
+async_iterator_from(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& caller_ref  = argv[0];
+    const ERL_NIF_TERM& itr_ref     = argv[1];
+    const ERL_NIF_TERM& options_ref = argv[2];
+
+    ReferencePtr<ItrObject> itr_ptr;
+
+    itr_ptr.assign(ItrObject::RetrieveItrObject(env, itr_ref));
+
+    if(NULL==itr_ptr.get()
+       || NULL==itr_ptr->m_Snapshot.get()
+       || !is_read_options(env, options_ref))
+    {
+        return enif_make_badarg(env);
+    }
+
+    if(NULL == itr_ptr->m_DbPtr.get() || NULL == itr_ptr->m_DbPtr->m_Db)
+        return send_reply(env, caller_ref, error_einval(env));
+
+    rocksdb::ReadOptions *opts = new rocksdb::ReadOptions;
+    bool zero_copy(false);
+    get_read_options(env, options_ref, *opts, zero_copy);
+
+    erocksdb::IterateBounds bounds;
+    get_iterate_bounds(env, options_ref, bounds);
+
+    erocksdb::WorkTask *work_item = new erocksdb::IterTask(env, caller_ref,
+                                                           itr_ptr->m_DbPtr.get(),
+                                                           itr_ptr->keys_only, opts,
+                                                           bounds, itr_ptr->m_Snapshot.get());
+
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
+        return send_reply(env, caller_ref, enif_make_tuple2(env, ATOM_ERROR, caller_ref));
+    }   // if
+
+    return ATOM_OK;
+
+}   // async_iterator_from
+
+
+ERL_NIF_TERM
+async_iterator_move(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    // const ERL_NIF_TERM& caller_ref       = argv[0];
+    const ERL_NIF_TERM& itr_handle_ref   = argv[1];
+    const ERL_NIF_TERM& action_or_target = argv[2];
+    ERL_NIF_TERM ret_term;
+
+    bool submit_new_request(true);
+
+    ReferencePtr<ItrObject> itr_ptr;
+
+    itr_ptr.assign(ItrObject::RetrieveItrObject(env, itr_handle_ref));
+
+    if(NULL==itr_ptr.get())
+        return enif_make_badarg(env);
+
+    // Reuse ref from iterator creation
+    const ERL_NIF_TERM& caller_ref = itr_ptr->m_Iter->itr_ref;
+
+    /* We can be invoked with two different arities from Erlang. If our "action_atom" parameter is not
+       in fact an atom, then it is actually a seek target. Let's find out which we are: */
+    erocksdb::MoveTask::action_t action = erocksdb::MoveTask::SEEK;
+    unsigned batch_count(0);
+    int arity;
+    const ERL_NIF_TERM* batch;
+
+    // If we have an atom, it's one of these (action_or_target's value is ignored):
+    if(enif_is_atom(env, action_or_target))
+    {
+        if(ATOM_FIRST == action_or_target)  action = erocksdb::MoveTask::FIRST;
+        if(ATOM_LAST == action_or_target)   action = erocksdb::MoveTask::LAST;
+        if(ATOM_NEXT == action_or_target)   action = erocksdb::MoveTask::NEXT;
+        if(ATOM_PREV == action_or_target)   action = erocksdb::MoveTask::PREV;
+        // if(ATOM_PREFETCH == action_or_target)   action = erocksdb::MoveTask::PREFETCH;
+    }   // if
+
+    // {next, N} or {prev, N}:  up to N entries in one reply
+    else if (enif_get_tuple(env, action_or_target, &arity, &batch) && 2==arity)
+    {
+        if (ATOM_NEXT == batch[0])      action = erocksdb::MoveTask::NEXT;
+        else if (ATOM_PREV == batch[0]) action = erocksdb::MoveTask::PREV;
+        else return enif_make_badarg(env);
+
+        if (!enif_get_uint(env, batch[1], &batch_count) || 0==batch_count)
+            return enif_make_badarg(env);
+    }   // else if
+
+    // {scan, first | next | StartKey, undefined | EndKey, N}:  chunk of a
+    //  range fold, stops before EndKey
+    else if (enif_get_tuple(env, action_or_target, &arity, &batch) && 4==arity
+             && ATOM_SCAN == batch[0])
+    {
+        action = erocksdb::MoveTask::SCAN;
+
+        if (!enif_get_uint(env, batch[3], &batch_count) || 0==batch_count)
+            return enif_make_badarg(env);
+    }   // else if
+
+    // adaptive prefetch:  a run of single next calls turns into PREFETCH,
+    //  any other action ends the run and makes queued prefetches stale
+    if (erocksdb::MoveTask::NEXT == action && 0==batch_count)
+    {
+        if (erocksdb::PREFETCH_AFTER_NEXTS < ++itr_ptr->m_Iter->m_NextStreak)
+            action = erocksdb::MoveTask::PREFETCH;
+    }   // if
+    else
+    {
+        itr_ptr->m_Iter->m_NextStreak=0;
+
+        if (itr_ptr->m_Iter->m_PrefetchStarted)
+        {
+            erocksdb::inc_and_fetch(&itr_ptr->m_Iter->m_PrefetchGeneration);
+            itr_ptr->m_Iter->m_PrefetchStarted=false;
+        }   // if
+    }   // else
+
+
+    //
+    // Four situations:
+    //  #1 not a PREFETCH next call
+    //  #2 PREFETCH call and no prefetch waiting
+    //  #3 PREFETCH call and prefetch is waiting
+    //  #4 as #3, but the iterator is locked by a worker
+
+    // case #1
+    if (erocksdb::MoveTask::PREFETCH != action)
+    {
+        // current move object could still be in later stages of
+        //  worker thread completion ... race condition ...don't reuse
+        itr_ptr->ReleaseReuseMove();
+
+        // non-prefetch tasks always reply by message
+        submit_new_request=true;
+        ret_term = enif_make_copy(env, itr_ptr->m_Iter->itr_ref);
+    }   // if
+
+    // case #2
+    // before we launch a background job for "next iteration", see if there is a
+    //  prefetch waiting for us
+    else if (erocksdb::compare_and_swap(&itr_ptr->m_Iter->m_HandoffAtomic, 0, 1))
+    {
+        // nope, no prefetch ... await a message to erlang queue
+        ret_term = enif_make_copy(env, itr_ptr->m_Iter->itr_ref);
+
+        // is this truly a wait for prefetch ... or actually the first prefetch request
+        if (!itr_ptr->m_Iter->m_PrefetchStarted)
+        {
+            submit_new_request=true;
+            itr_ptr->m_Iter->m_PrefetchStarted=true;
+            itr_ptr->ReleaseReuseMove();
+
+            // first must return via message
+            itr_ptr->m_Iter->m_HandoffAtomic=1;
+        }   // if
+
+        else
+        {
+            // await message that is already in the making
+            submit_new_request=false;
+        }   // else
+    }   // else if
+
+    // case #3
+    // why yes there is.  copy the key/value info into a return tuple before
+    //  we launch the iterator for "next" again.  The parked task is done,
+    //  the lock only orders this with its last writes
+    else if (itr_ptr->m_Iter->m_IterMutex.TryLock())
+    {
+        if(!itr_ptr->m_Iter->Valid())
+            ret_term=enif_make_tuple2(env, ATOM_ERROR, ATOM_INVALID_ITERATOR);
+
+        else if (itr_ptr->m_Iter->m_KeysOnly)
+            ret_term=enif_make_tuple2(env, ATOM_OK, slice_to_binary(env, itr_ptr->m_Iter->key()));
+        else
+            ret_term=enif_make_tuple3(env, ATOM_OK,
+                                      slice_to_binary(env, itr_ptr->m_Iter->key()),
+                                      slice_to_binary(env, itr_ptr->m_Iter->value()));
+
+        // reset for next race, erlang has caught up with the iterator
+        itr_ptr->m_Iter->m_Ahead=false;
+        itr_ptr->m_Iter->m_HandoffAtomic=0;
+
+        itr_ptr->m_Iter->m_IterMutex.Unlock();
+
+        // old MoveItem could still be active on its thread, cannot
+        //  reuse ... but the current Iterator is good
+        itr_ptr->ReleaseReuseMove();
+
+        submit_new_request=true;
+    }   // else if
+
+    // case #4
+    // prefetch is waiting but a worker still holds the iterator (the
+    //  parked task finishing up or a stream chunk doing I/O).  Do not
+    //  block this scheduler thread, a PARKED task replies by message
+    else
+    {
+        action = erocksdb::MoveTask::PARKED;
+        ret_term = enif_make_copy(env, itr_ptr->m_Iter->itr_ref);
+
+        itr_ptr->ReleaseReuseMove();
+
+        submit_new_request=true;
+    }   // else
+
+
+    // only build request if actually need to submit it
+    if (submit_new_request)
+    {
+        erocksdb::MoveTask * move_item;
+
+        move_item = new erocksdb::MoveTask(env, caller_ref,
+                                           itr_ptr->m_Iter.get(), action);
+
+        // prevent deletes during worker loop
+        move_item->RefInc();
+        itr_ptr->reuse_move=move_item;
+
+        move_item->action=action;
+        move_item->batch_count=batch_count;
+
+        if (erocksdb::MoveTask::SCAN == action
+            && !move_item->SetScanRange(env, batch[1], batch[2]))
+        {
+            itr_ptr->ReleaseReuseMove();
+            itr_ptr->reuse_move=NULL;
+            return enif_make_badarg(env);
+        }   // if
+
+        if (erocksdb::MoveTask::SEEK == action)
+        {
+            ErlNifBinary key;
+
+            if(!enif_inspect_binary(env, action_or_target, &key))
+            {
+                itr_ptr->ReleaseReuseMove();
+		itr_ptr->reuse_move=NULL;
+                return enif_make_tuple2(env, ATOM_EINVAL, caller_ref);
+            }   // if
+
+            move_item->seek_target.assign((const char *)key.data, key.size);
+        }   // else
+
+        erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+
+        if(false == priv.thread_pool.submit(move_item))
+        {
+            itr_ptr->ReleaseReuseMove();
+	    itr_ptr->reuse_move=NULL;
+            return enif_make_tuple2(env, ATOM_ERROR, caller_ref);
+        }   // if
+    }   // if
+
+    return ret_term;
+
+}   // async_iter_move
+
+
+} // namespace erocksdb
+
+
+/***
+ * HEY YOU, please convert this to an async operation
+ */
+
+ERL_NIF_TERM
+erocksdb_close(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::DbObject * db_ptr;
+    ERL_NIF_TERM ret_term;
+
+    ret_term=erocksdb::ATOM_OK;
+
+    db_ptr=erocksdb::DbObject::RetrieveDbObject(env, argv[0]);
+
+    if (NULL!=db_ptr)
+    {
+        // set closing flag
+        erocksdb::ErlRefObject::InitiateCloseRequest(db_ptr);
+
+        db_ptr=NULL;
+
+        ret_term=erocksdb::ATOM_OK;
+    }   // if
+    else
+    {
+        ret_term=enif_make_badarg(env);
+    }   // else
+
+    return(ret_term);
+
+}  // erocksdb_close
+
+
+ERL_NIF_TERM
+erocksdb_iterator_close(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ItrObject * itr_ptr;
+    ERL_NIF_TERM ret_term;
+
+    ret_term=erocksdb::ATOM_OK;
+
+    itr_ptr=erocksdb::ItrObject::RetrieveItrObject(env, argv[0], true);
+
+    if (NULL!=itr_ptr)
+    {
+        itr_ptr->ReleaseReuseMove();
+
+        // set closing flag ... atomic likely unnecessary (but safer)
+        erocksdb::ErlRefObject::InitiateCloseRequest(itr_ptr);
+
+        itr_ptr=NULL;
+
+        ret_term=erocksdb::ATOM_OK;
+    }   // if
+    else
+    {
+        ret_term=enif_make_badarg(env);
+    }   // else
+
+    return(ret_term);
+
+}   // elveldb_iterator_close
+
+
+ERL_NIF_TERM
+erocksdb_status(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    ErlNifBinary name_bin;
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get()
+       && enif_inspect_binary(env, argv[1], &name_bin))
+    {
+        if (db_ptr->m_Db == NULL)
+        {
+            return error_einval(env);
+        }
+
+        rocksdb::Slice name((const char*)name_bin.data, name_bin.size);
+        std::string value;
+        bool found;
+
+        // erocksdb's own counters, everything else goes to rocksdb
+        if (0==name.compare(rocksdb::Slice("erocksdb.coalesced-gets")))
+        {
+            erocksdb::MutexLock lock(db_ptr->m_InFlightMutex);
+            value=std::to_string(db_ptr->m_CoalescedGets);
+            found=true;
+        }   // if
+        else
+        {
+            found=db_ptr->m_Db->GetProperty(name, &value);
+        }   // else
+
+        if (found)
+        {
+            ERL_NIF_TERM result;
+            unsigned char* result_buf = enif_make_new_binary(env, value.size(), &result);
+            memcpy(result_buf, value.c_str(), value.size());
+
+            return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
+        }
+        else
+        {
+            return erocksdb::ATOM_ERROR;
+        }
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_status
+
+
+ERL_NIF_TERM
+erocksdb_repair(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    char name[4096];
+    if (enif_get_string(env, argv[0], name, sizeof(name), ERL_NIF_LATIN1) &&
+        enif_is_list(env, argv[1]))
+    {
+        // Parse out the options
+        rocksdb::Options opts;
+        fold(env, argv[1], parse_db_option, opts);
+
+        rocksdb::Status status = rocksdb::RepairDB(name, opts);
+        if (!status.ok())
+        {
+            return error_tuple(env, erocksdb::ATOM_ERROR_DB_REPAIR, status);
+        }
+        else
+        {
+            return erocksdb::ATOM_OK;
+        }
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_repair
+
+/**
+ * HEY YOU ... please make async
+ */
+ERL_NIF_TERM
+erocksdb_destroy(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    char name[4096];
+    if (enif_get_string(env, argv[0], name, sizeof(name), ERL_NIF_LATIN1) &&
+        enif_is_list(env, argv[1]))
+    {
+        // Parse out the options
+        rocksdb::Options opts;
+        fold(env, argv[1], parse_db_option, opts);
+
+        rocksdb::Status status = rocksdb::DestroyDB(name, opts);
+        if (!status.ok())
+        {
+            return error_tuple(env, erocksdb::ATOM_ERROR_DB_DESTROY, status);
+        }
+        else
+        {
+            return erocksdb::ATOM_OK;
+        }
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+
+}   // erocksdb_destroy
+
+
+ERL_NIF_TERM
+erocksdb_is_empty(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get())
+    {
+        if (db_ptr->m_Db == NULL)
+        {
+            return error_einval(env);
+        }
+
+        rocksdb::ReadOptions opts;
+        rocksdb::Iterator* itr = db_ptr->m_Db->NewIterator(opts);
+        itr->SeekToFirst();
+        ERL_NIF_TERM result;
+        if (itr->Valid())
+        {
+            result = erocksdb::ATOM_FALSE;
+        }
+        else
+        {
+            result = erocksdb::ATOM_TRUE;
+        }
+        delete itr;
+
+        return result;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_is_empty
+
+
+/**
+ * Existence probes answered from memtable and filter blocks only.
+ *  KeyMayExist never performs disk I/O, so these run inline.
+ *  false is definite, true may be a false positive.
+ */
+ERL_NIF_TERM
+erocksdb_key_may_exist(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    ErlNifBinary key;
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get()
+       && enif_inspect_binary(env, argv[1], &key)
+       && is_read_options(env, argv[2]))
+    {
+        if (db_ptr->m_Db == NULL)
+        {
+            return error_einval(env);
+        }
+
+        rocksdb::ReadOptions opts;
+        bool zero_copy(false);
+        get_read_options(env, argv[2], opts, zero_copy);
+
+        rocksdb::Slice key_slice((const char*)key.data, key.size);
+        std::string value;
+
+        return (db_ptr->m_Db->KeyMayExist(opts, key_slice, &value) ?
+                erocksdb::ATOM_TRUE : erocksdb::ATOM_FALSE);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_key_may_exist
+
+
+ERL_NIF_TERM
+erocksdb_keys_may_exist(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+    unsigned key_count;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    // the probes run on the scheduler, so the batch is bounded
+    if(NULL!=db_ptr.get()
+       && enif_get_list_length(env, argv[1], &key_count)
+       && key_count<=erocksdb::KEYS_MAY_EXIST_MAX
+       && is_read_options(env, argv[2]))
+    {
+        if (db_ptr->m_Db == NULL)
+        {
+            return error_einval(env);
+        }
+
+        rocksdb::ReadOptions opts;
+        bool zero_copy(false);
+        get_read_options(env, argv[2], opts, zero_copy);
+
+        ERL_NIF_TERM head, tail;
+        ErlNifBinary key;
+        std::string value;
+        std::vector<ERL_NIF_TERM> results;
+
+        tail=argv[1];
+        while (enif_get_list_cell(env, tail, &head, &tail))
+        {
+            if (!enif_inspect_binary(env, head, &key))
+                return enif_make_badarg(env);
+
+            rocksdb::Slice key_slice((const char*)key.data, key.size);
+            results.push_back(db_ptr->m_Db->KeyMayExist(opts, key_slice, &value) ?
+                              erocksdb::ATOM_TRUE : erocksdb::ATOM_FALSE);
+        }
+
+        // a full batch counts as a whole timeslice
+        if (0!=key_count)
+            enif_consume_timeslice(env, 1+(99*key_count)/erocksdb::KEYS_MAY_EXIST_MAX);
+
+        return enif_make_list_from_array(env, results.empty() ? NULL : &results[0],
+                                         results.size());
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_keys_may_exist
+
+
+ERL_NIF_TERM
+erocksdb_new_cache(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    ErlNifUInt64 capacity;
+    int num_shard_bits;
+
+    // rocksdb allocates 1<<num_shard_bits shards, same limit as its own
+    if (enif_get_uint64(env, argv[0], &capacity) &&
+        enif_get_int(env, argv[1], &num_shard_bits) &&
+        0<=num_shard_bits && num_shard_bits<erocksdb::CACHE_MAX_SHARD_BITS)
+    {
+        erocksdb::CacheObject * cache_ptr;
+
+        cache_ptr=erocksdb::CacheObject::CreateCacheObject(capacity, num_shard_bits);
+
+        ERL_NIF_TERM result = enif_make_resource(env, cache_ptr);
+
+        // clear the automatic reference from enif_alloc_resource in CreateCacheObject
+        enif_release_resource(cache_ptr);
+
+        return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_new_cache
+
+
+ERL_NIF_TERM
+erocksdb_cache_info(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::CacheObject * cache_ptr;
+
+    cache_ptr=erocksdb::CacheObject::RetrieveCacheObject(env, argv[0]);
+
+    if (NULL!=cache_ptr)
+    {
+        ERL_NIF_TERM info[4];
+
+        info[0]=enif_make_tuple2(env, erocksdb::ATOM_CAPACITY,
+                                 enif_make_uint64(env, cache_ptr->m_Cache->GetCapacity()));
+        info[1]=enif_make_tuple2(env, erocksdb::ATOM_USAGE,
+                                 enif_make_uint64(env, cache_ptr->m_Cache->GetUsage()));
+        info[2]=enif_make_tuple2(env, erocksdb::ATOM_HITS,
+                                 enif_make_uint64(env, cache_ptr->m_Statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT)));
+        info[3]=enif_make_tuple2(env, erocksdb::ATOM_MISSES,
+                                 enif_make_uint64(env, cache_ptr->m_Statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS)));
+
+        return enif_make_list_from_array(env, info, 4);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_cache_info
+
+
+ERL_NIF_TERM
+erocksdb_write_watermark(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get())
+    {
+        uint64_t watermark, failed;
+
+        db_ptr->GetWriteWatermark(watermark, failed);
+
+        return enif_make_tuple2(env, enif_make_uint64(env, watermark),
+                                enif_make_uint64(env, failed));
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_write_watermark
+
+
+ERL_NIF_TERM
+erocksdb_subscribe_write_watermark(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get())
+    {
+        ErlNifPid pid;
+
+        enif_self(env, &pid);
+        db_ptr->SubscribeWriteWatermark(pid);
+
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_subscribe_write_watermark
+
+
+ERL_NIF_TERM
+erocksdb_unsubscribe_write_watermark(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get())
+    {
+        ErlNifPid pid;
+
+        enif_self(env, &pid);
+        db_ptr->UnsubscribeWriteWatermark(pid);
+
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_unsubscribe_write_watermark
+
+
+ERL_NIF_TERM
+erocksdb_subscribe_events(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get() && NULL!=db_ptr->m_ObjectOptions.m_EventListener.get())
+    {
+        ErlNifPid pid;
+
+        enif_self(env, &pid);
+        db_ptr->m_ObjectOptions.m_EventListener->Subscribe(pid);
+
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_subscribe_events
+
+
+ERL_NIF_TERM
+erocksdb_unsubscribe_events(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+
+    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+
+    if(NULL!=db_ptr.get() && NULL!=db_ptr->m_ObjectOptions.m_EventListener.get())
+    {
+        ErlNifPid pid;
+
+        enif_self(env, &pid);
+        db_ptr->m_ObjectOptions.m_EventListener->Unsubscribe(pid);
+
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_unsubscribe_events
+
+
+ERL_NIF_TERM
+erocksdb_new_rate_limiter(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    ErlNifSInt64 bytes_per_sec;
+
+    if (enif_get_int64(env, argv[0], &bytes_per_sec) && 0<bytes_per_sec)
+    {
+        erocksdb::RateLimiterObject * limiter_ptr;
+
+        limiter_ptr=erocksdb::RateLimiterObject::CreateRateLimiterObject(bytes_per_sec);
+
+        ERL_NIF_TERM result = enif_make_resource(env, limiter_ptr);
+
+        // clear the automatic reference from enif_alloc_resource in CreateRateLimiterObject
+        enif_release_resource(limiter_ptr);
+
+        return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_new_rate_limiter
+
+
+ERL_NIF_TERM
+erocksdb_set_rate_limit(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::RateLimiterObject * limiter_ptr;
+    ErlNifSInt64 bytes_per_sec;
+
+    limiter_ptr=erocksdb::RateLimiterObject::RetrieveRateLimiterObject(env, argv[0]);
+
+    if (NULL!=limiter_ptr
+        && enif_get_int64(env, argv[1], &bytes_per_sec) && 0<bytes_per_sec)
+    {
+        limiter_ptr->m_Limiter->SetRate(bytes_per_sec);
+
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_set_rate_limit
+
+
+ERL_NIF_TERM
+erocksdb_read_options(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    if (enif_is_list(env, argv[0]))
+    {
+        erocksdb::ReadOptionsObject * opts_ptr;
+
+        opts_ptr=erocksdb::ReadOptionsObject::CreateReadOptionsObject();
+        fold(env, argv[0], parse_read_option, opts_ptr->m_Options);
+        fold(env, argv[0], parse_zero_copy_option, opts_ptr->m_ZeroCopy);
+        fold(env, argv[0], parse_iterate_bound_option, opts_ptr->m_Bounds);
+
+        ERL_NIF_TERM result = enif_make_resource(env, opts_ptr);
+
+        // clear the automatic reference from enif_alloc_resource in CreateReadOptionsObject
+        enif_release_resource(opts_ptr);
+
+        return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_read_options
+
+
+ERL_NIF_TERM
+erocksdb_write_options(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    if (enif_is_list(env, argv[0]))
+    {
+        erocksdb::WriteOptionsObject * opts_ptr;
+
+        opts_ptr=erocksdb::WriteOptionsObject::CreateWriteOptionsObject();
+        fold(env, argv[0], parse_write_option, opts_ptr->m_Options);
+        fold(env, argv[0], parse_noreply_option, opts_ptr->m_NoReply);
+        fold(env, argv[0], parse_compact_range_option, opts_ptr->m_CompactRange);
+
+        ERL_NIF_TERM result = enif_make_resource(env, opts_ptr);
+
+        // clear the automatic reference from enif_alloc_resource in CreateWriteOptionsObject
+        enif_release_resource(opts_ptr);
+
+        return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_write_options
+
+
+// queue the next chunk of a stream, caller already set m_Running
+static bool
+submit_stream_task(
+    ErlNifEnv* env,
+    ERL_NIF_TERM stream_ref,
+    erocksdb::StreamObject * stream_ptr)
+{
+    erocksdb::RocksIteratorWrapper * wrap_ptr;
 
-    //
-    // Three situations:
-    //  #1 not a PREFETCH next call
-    //  #2 PREFETCH call and no prefetch waiting
-    //  #3 PREFETCH call and prefetch is waiting
+    // a closed ItrObject may have released its wrapper already,
+    //  the task then reports iterator_closed
+    wrap_ptr=stream_ptr->m_Itr->m_CloseRequested ? NULL : stream_ptr->m_Itr->m_Iter.get();
 
-    // case #1
-    if (erocksdb::MoveTask::PREFETCH != action)
-    {
-        // current move object could still be in later stages of
-        //  worker thread completion ... race condition ...don't reuse
-        itr_ptr->ReleaseReuseMove();
+    erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
 
-        submit_new_request=true;
-        ret_term = enif_make_copy(env, itr_ptr->m_Snapshot->itr_ref);
+    erocksdb::WorkTask* work_item = new erocksdb::StreamTask(stream_ref, stream_ptr, wrap_ptr);
+
+    if(false == priv.thread_pool.submit(work_item))
+    {
+        delete work_item;
 
-        // force reply to be a message
-        itr_ptr->m_Iter->m_HandoffAtomic=1;
+        erocksdb::MutexLock lock(stream_ptr->m_StreamMutex);
+        stream_ptr->m_Running=false;
+        return(false);
     }   // if
 
-    // case #2
-    // before we launch a background job for "next iteration", see if there is a
-    //  prefetch waiting for us
-    else if (erocksdb::compare_and_swap(&itr_ptr->m_Iter->m_HandoffAtomic, 0, 1))
-    {
-        // nope, no prefetch ... await a message to erlang queue
-        ret_term = enif_make_copy(env, itr_ptr->m_Snapshot->itr_ref);
+    return(true);
 
-        // is this truly a wait for prefetch ... or actually the first prefetch request
-        if (!itr_ptr->m_Iter->m_PrefetchStarted)
-        {
-            submit_new_request=true;
-            itr_ptr->m_Iter->m_PrefetchStarted=true;
-            itr_ptr->ReleaseReuseMove();
+}   // submit_stream_task
 
-            // first must return via message
-            itr_ptr->m_Iter->m_HandoffAtomic=1;
-        }   // if
 
-        else
-        {
-            // await message that is already in the making
-            submit_new_request=false;
-        }   // else
-    }   // else if
+ERL_NIF_TERM
+erocksdb_stream_open(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& itr_ref     = argv[0];
+    const ERL_NIF_TERM& start_ref   = argv[1];
+    const ERL_NIF_TERM& end_ref     = argv[2];
+    const ERL_NIF_TERM& pid_ref     = argv[3];
+    const ERL_NIF_TERM& credits_ref = argv[4];
+    const ERL_NIF_TERM& chunk_ref   = argv[5];
 
-    // case #3
-    else
+    erocksdb::ItrObject * itr_ptr;
+    ErlNifBinary start, end;
+    ErlNifPid pid;
+    ErlNifUInt64 credits;
+    unsigned chunk_size;
+    bool has_end;
+
+    itr_ptr=erocksdb::ItrObject::RetrieveItrObject(env, itr_ref);
+    has_end=(erocksdb::ATOM_UNDEFINED != end_ref);
+
+    if(NULL==itr_ptr
+       || !enif_inspect_binary(env, start_ref, &start)
+       || (has_end && !enif_inspect_binary(env, end_ref, &end))
+       || !enif_get_local_pid(env, pid_ref, &pid)
+       || !enif_get_uint64(env, credits_ref, &credits)
+       || !enif_get_uint(env, chunk_ref, &chunk_size) || 0==chunk_size)
     {
-        // why yes there is.  copy the key/value info into a return tuple before
-        //  we launch the iterator for "next" again
-        if(!itr_ptr->m_Iter->Valid())
-            ret_term=enif_make_tuple2(env, ATOM_ERROR, ATOM_INVALID_ITERATOR);
+        return enif_make_badarg(env);
+    }
 
-        else if (itr_ptr->m_Iter->m_KeysOnly)
-            ret_term=enif_make_tuple2(env, ATOM_OK, slice_to_binary(env, itr_ptr->m_Iter->key()));
-        else
-            ret_term=enif_make_tuple3(env, ATOM_OK,
-                                      slice_to_binary(env, itr_ptr->m_Iter->key()),
-                                      slice_to_binary(env, itr_ptr->m_Iter->value()));
+    erocksdb::StreamObject * stream_ptr;
+    rocksdb::Slice end_slice;
 
-        // reset for next race
-        itr_ptr->m_Iter->m_HandoffAtomic=0;
+    if (has_end)
+        end_slice=rocksdb::Slice((const char*)end.data, end.size);
 
-        // old MoveItem could still be active on its thread, cannot
-        //  reuse ... but the current Iterator is good
-        itr_ptr->ReleaseReuseMove();
+    stream_ptr=erocksdb::StreamObject::CreateStreamObject(itr_ptr,
+                                                          rocksdb::Slice((const char*)start.data, start.size),
+                                                          has_end ? &end_slice : NULL,
+                                                          pid, chunk_size);
+    stream_ptr->m_Credits=credits;
+    stream_ptr->m_Running=(0<credits);
 
-        submit_new_request=true;
-    }   // else
+    ERL_NIF_TERM result = enif_make_resource(env, stream_ptr);
 
+    // clear the automatic reference from enif_alloc_resource in CreateStreamObject
+    enif_release_resource(stream_ptr);
 
-    // only build request if actually need to submit it
-    if (submit_new_request)
+    if (stream_ptr->m_Running && !submit_stream_task(env, result, stream_ptr))
     {
-        erocksdb::MoveTask * move_item;
+        stream_ptr->Close();
+        return enif_make_tuple2(env, erocksdb::ATOM_ERROR, result);
+    }   // if
 
-        move_item = new erocksdb::MoveTask(env, caller_ref,
-                                           itr_ptr->m_Iter.get(), action);
+    return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
 
-        // prevent deletes during worker loop
-        move_item->RefInc();
-        itr_ptr->reuse_move=move_item;
+}   // erocksdb_stream_open
 
-        move_item->action=action;
 
-        if (erocksdb::MoveTask::SEEK == action)
-        {
-            ErlNifBinary key;
+ERL_NIF_TERM
+erocksdb_stream_ack(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    const ERL_NIF_TERM& stream_ref  = argv[0];
+    const ERL_NIF_TERM& credits_ref = argv[1];
 
-            if(!enif_inspect_binary(env, action_or_target, &key))
-            {
-                itr_ptr->ReleaseReuseMove();
-		itr_ptr->reuse_move=NULL;
-                return enif_make_tuple2(env, ATOM_EINVAL, caller_ref);
-            }   // if
+    erocksdb::StreamObject * stream_ptr;
+    ErlNifUInt64 credits;
+    bool submit(false);
 
-            move_item->seek_target.assign((const char *)key.data, key.size);
-        }   // else
+    stream_ptr=erocksdb::StreamObject::RetrieveStreamObject(env, stream_ref);
 
-        erocksdb_priv_data& priv = *static_cast<erocksdb_priv_data *>(enif_priv_data(env));
+    if(NULL==stream_ptr || !enif_get_uint64(env, credits_ref, &credits))
+    {
+        return enif_make_badarg(env);
+    }
 
-        if(false == priv.thread_pool.submit(move_item))
+    // credits after the end are ignored
+    {
+        erocksdb::MutexLock lock(stream_ptr->m_StreamMutex);
+
+        if (!stream_ptr->m_Done && 0<credits)
         {
-            itr_ptr->ReleaseReuseMove();
-	    itr_ptr->reuse_move=NULL;
-            return enif_make_tuple2(env, ATOM_ERROR, caller_ref);
+            stream_ptr->m_Credits+=credits;
+            submit=!stream_ptr->m_Running;
+            stream_ptr->m_Running=true;
         }   // if
-    }   // if
-
-    return ret_term;
-
-}   // async_iter_move
+    }
 
+    if (submit && !submit_stream_task(env, stream_ref, stream_ptr))
+        return enif_make_tuple2(env, erocksdb::ATOM_ERROR, stream_ref);
 
-} // namespace erocksdb
+    return erocksdb::ATOM_OK;
 
+}   // erocksdb_stream_ack
 
-/***
- * HEY YOU, please convert this to an async operation
- */
 
 ERL_NIF_TERM
-erocksdb_close(
+erocksdb_stream_close(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    erocksdb::DbObject * db_ptr;
-    ERL_NIF_TERM ret_term;
+    erocksdb::StreamObject * stream_ptr;
+    bool running;
 
-    ret_term=erocksdb::ATOM_OK;
+    stream_ptr=erocksdb::StreamObject::RetrieveStreamObject(env, argv[0]);
 
-    db_ptr=erocksdb::DbObject::RetrieveDbObject(env, argv[0]);
+    if(NULL==stream_ptr)
+    {
+        return enif_make_badarg(env);
+    }
 
-    if (NULL!=db_ptr)
     {
-        // set closing flag
-        erocksdb::ErlRefObject::InitiateCloseRequest(db_ptr);
+        erocksdb::MutexLock lock(stream_ptr->m_StreamMutex);
 
-        db_ptr=NULL;
+        stream_ptr->m_Done=true;
+        running=stream_ptr->m_Running;
+    }
 
-        ret_term=erocksdb::ATOM_OK;
-    }   // if
-    else
-    {
-        ret_term=enif_make_badarg(env);
-    }   // else
+    // a running StreamTask closes the iterator when it finishes
+    if (!running)
+        stream_ptr->Close();
 
-    return(ret_term);
+    return erocksdb::ATOM_OK;
 
-}  // erocksdb_close
+}   // erocksdb_stream_close
 
 
 ERL_NIF_TERM
-erocksdb_iterator_close(
+erocksdb_batch(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    erocksdb::ItrObject * itr_ptr;
-    ERL_NIF_TERM ret_term;
+    erocksdb::BatchObject * batch_ptr;
 
-    ret_term=erocksdb::ATOM_OK;
+    batch_ptr=erocksdb::BatchObject::CreateBatchObject();
 
-    itr_ptr=erocksdb::ItrObject::RetrieveItrObject(env, argv[0], true);
+    ERL_NIF_TERM result = enif_make_resource(env, batch_ptr);
 
-    if (NULL!=itr_ptr)
-    {
-        itr_ptr->ReleaseReuseMove();
+    // clear the automatic reference from enif_alloc_resource in CreateBatchObject
+    enif_release_resource(batch_ptr);
 
-        // set closing flag ... atomic likely unnecessary (but safer)
-        erocksdb::ErlRefObject::InitiateCloseRequest(itr_ptr);
+    return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
 
-        itr_ptr=NULL;
+}   // erocksdb_batch
 
-        ret_term=erocksdb::ATOM_OK;
-    }   // if
-    else
+
+ERL_NIF_TERM
+erocksdb_batch_put(
+    ErlNifEnv* env,
+    int argc,
+    const ERL_NIF_TERM argv[])
+{
+    erocksdb::BatchObject * batch_ptr;
+    ErlNifBinary key, value;
+
+    batch_ptr=erocksdb::BatchObject::RetrieveBatchObject(env, argv[0]);
+
+    if (NULL!=batch_ptr
+        && enif_inspect_binary(env, argv[1], &key)
+        && enif_inspect_binary(env, argv[2], &value))
     {
-        ret_term=enif_make_badarg(env);
-    }   // else
+        rocksdb::Slice key_slice((const char*)key.data, key.size);
+        rocksdb::Slice value_slice((const char*)value.data, value.size);
 
-    return(ret_term);
+        erocksdb::MutexLock lock(batch_ptr->m_BatchMutex);
+        batch_ptr->m_Batch.Put(key_slice, value_slice);
 
-}   // elveldb_iterator_close
+        return erocksdb::ATOM_OK;
+    }
+    else
+    {
+        return enif_make_badarg(env);
+    }
+}   // erocksdb_batch_put
 
 
 ERL_NIF_TERM
-erocksdb_status(
+erocksdb_batch_delete(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    ErlNifBinary name_bin;
-    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+    erocksdb::BatchObject * batch_ptr;
+    ErlNifBinary key;
 
-    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+    batch_ptr=erocksdb::BatchObject::RetrieveBatchObject(env, argv[0]);
 
-    if(NULL!=db_ptr.get()
-       && enif_inspect_binary(env, argv[1], &name_bin))
+    if (NULL!=batch_ptr
+        && enif_inspect_binary(env, argv[1], &key))
     {
-        if (db_ptr->m_Db == NULL)
-        {
-            return error_einval(env);
-        }
+        rocksdb::Slice key_slice((const char*)key.data, key.size);
 
-        rocksdb::Slice name((const char*)name_bin.data, name_bin.size);
-        std::string value;
-        if (db_ptr->m_Db->GetProperty(name, &value))
-        {
-            ERL_NIF_TERM result;
-            unsigned char* result_buf = enif_make_new_binary(env, value.size(), &result);
-            memcpy(result_buf, value.c_str(), value.size());
+        erocksdb::MutexLock lock(batch_ptr->m_BatchMutex);
+        batch_ptr->m_Batch.Delete(key_slice);
 
-            return enif_make_tuple2(env, erocksdb::ATOM_OK, result);
-        }
-        else
-        {
-            return erocksdb::ATOM_ERROR;
-        }
+        return erocksdb::ATOM_OK;
     }
     else
     {
         return enif_make_badarg(env);
     }
-}   // erocksdb_status
+}   // erocksdb_batch_delete
 
 
 ERL_NIF_TERM
-erocksdb_repair(
+erocksdb_batch_clear(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    char name[4096];
-    if (enif_get_string(env, argv[0], name, sizeof(name), ERL_NIF_LATIN1) &&
-        enif_is_list(env, argv[1]))
+    erocksdb::BatchObject * batch_ptr;
+
+    batch_ptr=erocksdb::BatchObject::RetrieveBatchObject(env, argv[0]);
+
+    if (NULL!=batch_ptr)
     {
-        // Parse out the options
-        rocksdb::Options opts;
-        fold(env, argv[1], parse_db_option, opts);
+        erocksdb::MutexLock lock(batch_ptr->m_BatchMutex);
+        batch_ptr->m_Batch.Clear();
 
-        rocksdb::Status status = rocksdb::RepairDB(name, opts);
-        if (!status.ok())
-        {
-            return error_tuple(env, erocksdb::ATOM_ERROR_DB_REPAIR, status);
-        }
-        else
-        {
-            return erocksdb::ATOM_OK;
-        }
+        return erocksdb::ATOM_OK;
     }
     else
     {
         return enif_make_badarg(env);
     }
-}   // erocksdb_repair
+}   // erocksdb_batch_clear
+
 
-/**
- * HEY YOU ... please make async
- */
 ERL_NIF_TERM
-erocksdb_destroy(
+erocksdb_batch_count(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    char name[4096];
-    if (enif_get_string(env, argv[0], name, sizeof(name), ERL_NIF_LATIN1) &&
-        enif_is_list(env, argv[1]))
+    erocksdb::BatchObject * batch_ptr;
+
+    batch_ptr=erocksdb::BatchObject::RetrieveBatchObject(env, argv[0]);
+
+    if (NULL!=batch_ptr)
     {
-        // Parse out the options
-        rocksdb::Options opts;
-        fold(env, argv[1], parse_db_option, opts);
+        erocksdb::MutexLock lock(batch_ptr->m_BatchMutex);
 
-        rocksdb::Status status = rocksdb::DestroyDB(name, opts);
-        if (!status.ok())
-        {
-            return error_tuple(env, erocksdb::ATOM_ERROR_DB_DESTROY, status);
-        }
-        else
-        {
-            return erocksdb::ATOM_OK;
-        }
+        return enif_make_int(env, batch_ptr->m_Batch.Count());
     }
     else
     {
         return enif_make_badarg(env);
     }
-
-}   // erocksdb_destroy
+}   // erocksdb_batch_count
 
 
 ERL_NIF_TERM
-erocksdb_is_empty(
+erocksdb_batch_data_size(
     ErlNifEnv* env,
     int argc,
     const ERL_NIF_TERM argv[])
 {
-    erocksdb::ReferencePtr<erocksdb::DbObject> db_ptr;
+    erocksdb::BatchObject * batch_ptr;
 
-    db_ptr.assign(erocksdb::DbObject::RetrieveDbObject(env, argv[0]));
+    batch_ptr=erocksdb::BatchObject::RetrieveBatchObject(env, argv[0]);
 
-    if(NULL!=db_ptr.get())
+    if (NULL!=batch_ptr)
     {
-        if (db_ptr->m_Db == NULL)
-        {
-            return error_einval(env);
-        }
-
-        rocksdb::ReadOptions opts;
-        rocksdb::Iterator* itr = db_ptr->m_Db->NewIterator(opts);
-        itr->SeekToFirst();
-        ERL_NIF_TERM result;
-        if (itr->Valid())
-        {
-            result = erocksdb::ATOM_FALSE;
-        }
-        else
-        {
-            result = erocksdb::ATOM_TRUE;
-        }
-        delete itr;
+        erocksdb::MutexLock lock(batch_ptr->m_BatchMutex);
 
-        return result;
+        return enif_make_uint64(env, batch_ptr->m_Batch.GetDataSize());
     }
     else
     {
         return enif_make_badarg(env);
     }
-}   // erocksdb_is_empty
+}   // erocksdb_batch_data_size
 
 
 static void on_unload(ErlNifEnv *env, void *priv_data)
@@ -1417,9 +3348,16 @@ try
     ret_val=0;
     *priv_data = NULL;
 
-    // inform erlang of our two resource types
+    // inform erlang of our resource types
     erocksdb::DbObject::CreateDbObjectType(env);
     erocksdb::ItrObject::CreateItrObjectType(env);
+    erocksdb::ValueObject::CreateValueObjectType(env);
+    erocksdb::CacheObject::CreateCacheObjectType(env);
+    erocksdb::BatchObject::CreateBatchObjectType(env);
+    erocksdb::RateLimiterObject::CreateRateLimiterObjectType(env);
+    erocksdb::ReadOptionsObject::CreateReadOptionsObjectType(env);
+    erocksdb::WriteOptionsObject::CreateWriteOptionsObjectType(env);
+    erocksdb::StreamObject::CreateStreamObjectType(env);
 
 // must initialize atoms before processing options
 #define ATOM(Id, Value) { Id = enif_make_atom(env, Value); }
@@ -1464,6 +3402,15 @@ try
     ATOM(erocksdb::ATOM_INPLACE_UPDATE_NUM_LOCKS, "inplace_update_num_locks");
     ATOM(erocksdb::ATOM_TABLE_FACTORY_BLOCK_CACHE_SIZE, "table_factory_block_cache_size");
     ATOM(erocksdb::ATOM_IN_MEMORY_MODE, "in_memory_mode");
+    ATOM(erocksdb::ATOM_BLOCK_CACHE, "block_cache");
+    ATOM(erocksdb::ATOM_BLOCK_CACHE_STATISTICS, "block_cache_statistics");
+    ATOM(erocksdb::ATOM_MERGE_OPERATOR, "merge_operator");
+    ATOM(erocksdb::ATOM_UINT64_ADD, "uint64_add");
+    ATOM(erocksdb::ATOM_APPEND, "append");
+    ATOM(erocksdb::ATOM_SET_UNION, "set_union");
+    ATOM(erocksdb::ATOM_BULK_LOAD, "bulk_load");
+    ATOM(erocksdb::ATOM_RATE_LIMITER, "rate_limiter");
+    ATOM(erocksdb::ATOM_CONFLICT, "conflict");
 
     // Related to DBOptions
     ATOM(erocksdb::ATOM_TOTAL_THREADS, "total_threads");
@@ -1500,12 +3447,17 @@ try
     ATOM(erocksdb::ATOM_USE_ADAPTIVE_MUTEX, "use_adaptive_mutex");
     ATOM(erocksdb::ATOM_BYTES_PER_SYNC, "bytes_per_sync");
 
+    // Related to erocksdb per database options
+    ATOM(erocksdb::ATOM_COALESCE_GETS, "coalesce_gets");
+
     // Related to Read Options
     ATOM(erocksdb::ATOM_VERIFY_CHECKSUMS, "verify_checksums");
     ATOM(erocksdb::ATOM_FILL_CACHE,"fill_cache");
     ATOM(erocksdb::ATOM_ITERATE_UPPER_BOUND,"iterate_upper_bound");
+    ATOM(erocksdb::ATOM_ITERATE_LOWER_BOUND,"iterate_lower_bound");
     ATOM(erocksdb::ATOM_TAILING,"tailing");
     ATOM(erocksdb::ATOM_TOTAL_ORDER_SEEK,"total_order_seek");
+    ATOM(erocksdb::ATOM_ZERO_COPY,"zero_copy");
 
     // Related to Write Options
     ATOM(erocksdb::ATOM_SYNC, "sync");
@@ -1517,6 +3469,7 @@ try
     ATOM(erocksdb::ATOM_CLEAR, "clear");
     ATOM(erocksdb::ATOM_PUT, "put");
     ATOM(erocksdb::ATOM_DELETE, "delete");
+    ATOM(erocksdb::ATOM_MERGE, "merge");
 
     // Related to Iterator Options
     ATOM(erocksdb::ATOM_FIRST, "first");
@@ -1554,6 +3507,8 @@ try
     ATOM(erocksdb::ATOM_ERROR_DB_WRITE, "db_write");
     ATOM(erocksdb::ATOM_ERROR_DB_DESTROY, "error_db_destroy");
     ATOM(erocksdb::ATOM_ERROR_DB_REPAIR, "error_db_repair");
+    ATOM(erocksdb::ATOM_ERROR_DB_BULK_LOAD, "error_db_bulk_load");
+    ATOM(erocksdb::ATOM_ERROR_DB_GET, "error_db_get");
     ATOM(erocksdb::ATOM_BAD_WRITE_ACTION, "bad_write_action");
     ATOM(erocksdb::ATOM_KEEP_RESOURCE_FAILED, "keep_resource_failed");
     ATOM(erocksdb::ATOM_ITERATOR_CLOSED, "iterator_closed");
@@ -1562,6 +3517,39 @@ try
     // Related to NIF initialize parameters
     ATOM(erocksdb::ATOM_WRITE_THREADS, "write_threads");
 
+    // Related to cache info
+    ATOM(erocksdb::ATOM_CAPACITY, "capacity");
+    ATOM(erocksdb::ATOM_USAGE, "usage");
+    ATOM(erocksdb::ATOM_HITS, "hits");
+    ATOM(erocksdb::ATOM_MISSES, "misses");
+
+    // Related to noreply writes
+    ATOM(erocksdb::ATOM_NOREPLY, "noreply");
+    ATOM(erocksdb::ATOM_WRITE_WATERMARK, "erocksdb_write_watermark");
+
+    // Related to delete_range
+    ATOM(erocksdb::ATOM_COMPACT_RANGE, "compact_range");
+
+    // Related to event notifications
+    ATOM(erocksdb::ATOM_EVENT, "erocksdb_event");
+    ATOM(erocksdb::ATOM_FLUSH_COMPLETED, "flush_completed");
+    ATOM(erocksdb::ATOM_COMPACTION_COMPLETED, "compaction_completed");
+    ATOM(erocksdb::ATOM_WRITE_STALL_BEGIN, "write_stall_begin");
+    ATOM(erocksdb::ATOM_WRITE_STALL_END, "write_stall_end");
+    ATOM(erocksdb::ATOM_SLOWDOWN, "slowdown");
+    ATOM(erocksdb::ATOM_STOP, "stop");
+
+    // Related to range scans
+    ATOM(erocksdb::ATOM_SCAN, "scan");
+    ATOM(erocksdb::ATOM_DONE, "done");
+    ATOM(erocksdb::ATOM_UNDEFINED, "undefined");
+    ATOM(erocksdb::ATOM_EXACT, "exact");
+    ATOM(erocksdb::ATOM_ESTIMATE, "estimate");
+
+    // Related to streaming scans
+    ATOM(erocksdb::ATOM_STREAM, "erocksdb_stream");
+    ATOM(erocksdb::ATOM_DATA, "data");
+
 #undef ATOM
 
 
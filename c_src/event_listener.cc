@@ -0,0 +1,200 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rocksdb/db.h"
+
+#ifndef INCL_EVENT_LISTENER_H
+    #include "event_listener.h"
+#endif
+
+#ifndef ATOMS_H
+    #include "atoms.h"
+#endif
+
+namespace erocksdb {
+
+void
+ErlangEventListener::Subscribe(
+    const ErlNifPid & Pid)
+{
+    MutexLock lock(m_Mutex);
+    std::vector<ErlNifPid>::iterator it;
+
+    for (it=m_Subscribers.begin(); m_Subscribers.end()!=it; ++it)
+        if (it->pid==Pid.pid)
+            return;
+
+    m_Subscribers.push_back(Pid);
+
+    return;
+
+}   // ErlangEventListener::Subscribe
+
+
+void
+ErlangEventListener::Unsubscribe(
+    const ErlNifPid & Pid)
+{
+    MutexLock lock(m_Mutex);
+    std::vector<ErlNifPid>::iterator it;
+
+    for (it=m_Subscribers.begin(); m_Subscribers.end()!=it; ++it)
+    {
+        if (it->pid==Pid.pid)
+        {
+            m_Subscribers.erase(it);
+            break;
+        }   // if
+    }   // for
+
+    return;
+
+}   // ErlangEventListener::Unsubscribe
+
+
+void
+ErlangEventListener::Send(
+    ErlNifEnv * MsgEnv,
+    ERL_NIF_TERM Event)
+{
+    std::vector<ErlNifPid>::iterator it;
+    ERL_NIF_TERM msg;
+
+    msg=enif_make_tuple2(MsgEnv, ATOM_EVENT, Event);
+
+    // enif_send clears the env, so each subscriber gets a copy,
+    //  a failed send means the subscriber died and is dropped
+    for (it=m_Subscribers.begin(); m_Subscribers.end()!=it; )
+    {
+        ErlNifEnv * copy_env=enif_alloc_env();
+        int sent;
+
+        sent=enif_send(NULL, &(*it), copy_env, enif_make_copy(copy_env, msg));
+        enif_free_env(copy_env);
+
+        if (sent)
+            ++it;
+        else
+            it=m_Subscribers.erase(it);
+    }   // for
+
+    enif_free_env(MsgEnv);
+
+    return;
+
+}   // ErlangEventListener::Send
+
+
+void
+ErlangEventListener::SetStallState(
+    ERL_NIF_TERM State)
+{
+    if (State!=m_StallState)
+    {
+        ErlNifEnv * msg_env=enif_alloc_env();
+
+        if (0!=State)
+            Send(msg_env, enif_make_tuple2(msg_env, ATOM_WRITE_STALL_BEGIN, State));
+        else
+            Send(msg_env, ATOM_WRITE_STALL_END);
+
+        m_StallState=State;
+    }   // if
+
+    return;
+
+}   // ErlangEventListener::SetStallState
+
+
+/**
+ * rocksdb 3.11 reports stalls only through the flush that caused
+ *  them:  a flush without the trigger flags means level 0 is below
+ *  the slowdown trigger again
+ */
+void
+ErlangEventListener::OnFlushCompleted(
+    rocksdb::DB* db,
+    const std::string& column_family_name,
+    const std::string& file_path,
+    bool triggered_writes_slowdown,
+    bool triggered_writes_stop)
+{
+    MutexLock lock(m_Mutex);
+    ErlNifEnv * msg_env=enif_alloc_env();
+    ERL_NIF_TERM cf_name, path;
+
+    memcpy(enif_make_new_binary(msg_env, column_family_name.size(), &cf_name),
+           column_family_name.data(), column_family_name.size());
+    memcpy(enif_make_new_binary(msg_env, file_path.size(), &path),
+           file_path.data(), file_path.size());
+
+    Send(msg_env, enif_make_tuple3(msg_env, ATOM_FLUSH_COMPLETED, cf_name, path));
+
+    if (triggered_writes_stop)
+        SetStallState(ATOM_STOP);
+    else if (triggered_writes_slowdown)
+        SetStallState(ATOM_SLOWDOWN);
+    else
+        SetStallState(0);
+
+    return;
+
+}   // ErlangEventListener::OnFlushCompleted
+
+
+void
+ErlangEventListener::OnCompactionCompleted(
+    rocksdb::DB* db,
+    const rocksdb::CompactionJobInfo& ci)
+{
+    MutexLock lock(m_Mutex);
+    ErlNifEnv * msg_env=enif_alloc_env();
+    ERL_NIF_TERM cf_name;
+
+    memcpy(enif_make_new_binary(msg_env, ci.cf_name.size(), &cf_name),
+           ci.cf_name.data(), ci.cf_name.size());
+
+    ERL_NIF_TERM event[5]={ATOM_COMPACTION_COMPLETED, cf_name,
+                           enif_make_uint64(msg_env, ci.stats.total_input_bytes),
+                           enif_make_uint64(msg_env, ci.stats.total_output_bytes),
+                           enif_make_int(msg_env, ci.output_level)};
+
+    Send(msg_env, enif_make_tuple_from_array(msg_env, event, 5));
+
+    // compaction drained level 0 below the slowdown trigger?
+    if (0!=m_StallState)
+    {
+        std::string l0_files;
+
+        if (db->GetProperty("rocksdb.num-files-at-level0", &l0_files)
+            && atoi(l0_files.c_str()) < db->GetOptions().level0_slowdown_writes_trigger)
+            SetStallState(0);
+    }   // if
+
+    return;
+
+}   // ErlangEventListener::OnCompactionCompleted
+
+} // namespace erocksdb
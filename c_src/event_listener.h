@@ -0,0 +1,80 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+#ifndef INCL_EVENT_LISTENER_H
+#define INCL_EVENT_LISTENER_H
+
+#include <string>
+#include <vector>
+
+#include "erl_nif.h"
+#include "rocksdb/listener.h"
+
+#ifndef INCL_MUTEX_H
+    #include "mutex.h"
+#endif
+
+namespace erocksdb {
+
+/**
+ * Forwards flush, compaction and write stall events of one database
+ *  to subscribed Erlang processes as {erocksdb_event, Event}.
+ *  Callbacks run on rocksdb background threads.
+ */
+class ErlangEventListener : public rocksdb::EventListener
+{
+protected:
+    Mutex m_Mutex;                       //!< protects members below
+    std::vector<ErlNifPid> m_Subscribers;
+    ERL_NIF_TERM m_StallState;           //!< ATOM_SLOWDOWN, ATOM_STOP or 0 when writes flow
+
+public:
+    ErlangEventListener() : m_StallState(0) {};
+
+    virtual ~ErlangEventListener() {};
+
+    void Subscribe(const ErlNifPid & Pid);
+
+    void Unsubscribe(const ErlNifPid & Pid);
+
+    virtual void OnFlushCompleted(rocksdb::DB* db, const std::string& column_family_name,
+                                  const std::string& file_path, bool triggered_writes_slowdown,
+                                  bool triggered_writes_stop);
+
+    virtual void OnCompactionCompleted(rocksdb::DB* db, const rocksdb::CompactionJobInfo& ci);
+
+protected:
+    // caller holds m_Mutex, Event is built in MsgEnv which this frees
+    void Send(ErlNifEnv * MsgEnv, ERL_NIF_TERM Event);
+
+    // caller holds m_Mutex
+    void SetStallState(ERL_NIF_TERM State);
+
+private:
+    ErlangEventListener(const ErlangEventListener &);            // no copy
+    ErlangEventListener & operator=(const ErlangEventListener &); // no assignment
+
+};  // class ErlangEventListener
+
+} // namespace erocksdb
+
+
+#endif  // INCL_EVENT_LISTENER_H
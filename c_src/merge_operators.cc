@@ -0,0 +1,225 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+
+#include <stdint.h>
+
+#ifndef INCL_MERGE_OPERATORS_H
+    #include "merge_operators.h"
+#endif
+
+namespace erocksdb {
+
+/**
+ * Returns false if Value is not an 8 byte counter
+ */
+static bool
+DecodeCounter(
+    const rocksdb::Slice & Value,
+    uint64_t & Counter)
+{
+    const unsigned char * data;
+
+    if (sizeof(uint64_t)!=Value.size())
+        return(false);
+
+    Counter=0;
+    data=(const unsigned char *)Value.data();
+    for (int loop=sizeof(uint64_t)-1; 0<=loop; --loop)
+        Counter=(Counter << 8) | data[loop];
+
+    return(true);
+
+}   // DecodeCounter
+
+
+bool
+UInt64AddOperator::Merge(
+    const rocksdb::Slice& key,
+    const rocksdb::Slice* existing_value,
+    const rocksdb::Slice& value,
+    std::string* new_value,
+    rocksdb::Logger* logger) const
+{
+    uint64_t sum, existing;
+
+    // rocksdb reports Corruption instead of losing the count
+    if (!DecodeCounter(value, sum))
+        return(false);
+
+    if (NULL!=existing_value)
+    {
+        if (!DecodeCounter(*existing_value, existing))
+            return(false);
+        sum+=existing;
+    }   // if
+
+    new_value->resize(sizeof(uint64_t));
+    for (size_t loop=0; loop<sizeof(uint64_t); ++loop, sum>>=8)
+        (*new_value)[loop]=(char)(sum & 0xff);
+
+    return(true);
+
+}   // UInt64AddOperator::Merge
+
+
+bool
+AppendOperator::Merge(
+    const rocksdb::Slice& key,
+    const rocksdb::Slice* existing_value,
+    const rocksdb::Slice& value,
+    std::string* new_value,
+    rocksdb::Logger* logger) const
+{
+    new_value->clear();
+
+    if (NULL!=existing_value)
+    {
+        new_value->reserve(existing_value->size() + m_Delimiter.size() + value.size());
+        new_value->assign(existing_value->data(), existing_value->size());
+        new_value->append(m_Delimiter);
+    }   // if
+
+    new_value->append(value.data(), value.size());
+
+    return(true);
+
+}   // AppendOperator::Merge
+
+
+/**
+ * Reads one element of an encoded set, returns false at the end
+ *  of input.  Sets Error on a truncated element.
+ */
+static bool
+NextElement(
+    const char * & Cursor,
+    const char * End,
+    rocksdb::Slice & Element,
+    bool & Error)
+{
+    const unsigned char * len_ptr;
+    uint32_t len;
+
+    if (Cursor==End)
+        return(false);
+
+    if (End-Cursor<4)
+    {
+        Error=true;
+        return(false);
+    }   // if
+
+    len_ptr=(const unsigned char *)Cursor;
+    len=((uint32_t)len_ptr[0]<<24) | ((uint32_t)len_ptr[1]<<16)
+        | ((uint32_t)len_ptr[2]<<8) | (uint32_t)len_ptr[3];
+    Cursor+=4;
+
+    if ((size_t)(End-Cursor)<len)
+    {
+        Error=true;
+        return(false);
+    }   // if
+
+    Element=rocksdb::Slice(Cursor, len);
+    Cursor+=len;
+
+    return(true);
+
+}   // NextElement
+
+
+static void
+AppendElement(
+    std::string & Set,
+    const rocksdb::Slice & Element)
+{
+    char len[4];
+
+    len[0]=(char)(Element.size() >> 24);
+    len[1]=(char)(Element.size() >> 16);
+    len[2]=(char)(Element.size() >> 8);
+    len[3]=(char)Element.size();
+
+    Set.append(len, 4);
+    Set.append(Element.data(), Element.size());
+
+}   // AppendElement
+
+
+bool
+SetUnionOperator::Merge(
+    const rocksdb::Slice& key,
+    const rocksdb::Slice* existing_value,
+    const rocksdb::Slice& value,
+    std::string* new_value,
+    rocksdb::Logger* logger) const
+{
+    const char * left, * left_end, * right, * right_end;
+    rocksdb::Slice left_elem, right_elem, last;
+    bool left_valid, right_valid, error, have_last;
+    int cmp;
+
+    error=false;
+    have_last=false;
+    new_value->clear();
+
+    left=(NULL!=existing_value ? existing_value->data() : NULL);
+    left_end=(NULL!=existing_value ? existing_value->data() + existing_value->size() : NULL);
+    right=value.data();
+    right_end=value.data() + value.size();
+
+    new_value->reserve((left_end-left) + (right_end-right));
+
+    left_valid=NextElement(left, left_end, left_elem, error);
+    right_valid=NextElement(right, right_end, right_elem, error);
+
+    // classic sorted merge, each side must itself be strictly ascending
+    while (!error && (left_valid || right_valid))
+    {
+        if (left_valid && right_valid)
+            cmp=left_elem.compare(right_elem);
+        else
+            cmp=(left_valid ? -1 : 1);
+
+        const rocksdb::Slice & next=(cmp<=0 ? left_elem : right_elem);
+
+        if (have_last && next.compare(last)<=0)
+        {
+            error=true;
+            break;
+        }   // if
+
+        AppendElement(*new_value, next);
+        last=next;
+        have_last=true;
+
+        if (cmp<=0)
+            left_valid=NextElement(left, left_end, left_elem, error);
+        if (0<=cmp)
+            right_valid=NextElement(right, right_end, right_elem, error);
+    }   // while
+
+    return(!error);
+
+}   // SetUnionOperator::Merge
+
+} // namespace erocksdb
@@ -0,0 +1,89 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+#ifndef INCL_MERGE_OPERATORS_H
+#define INCL_MERGE_OPERATORS_H
+
+#include <string>
+
+#include "rocksdb/merge_operator.h"
+#include "rocksdb/slice.h"
+
+namespace erocksdb {
+
+/**
+ * Counter:  values and operands are 8 byte little endian unsigned
+ *  integers (same encoding as rocksdb's uint64add utility).  Merge
+ *  fails on any other size.
+ */
+class UInt64AddOperator : public rocksdb::AssociativeMergeOperator
+{
+public:
+    virtual bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existing_value,
+                       const rocksdb::Slice& value, std::string* new_value,
+                       rocksdb::Logger* logger) const;
+
+    virtual const char* Name() const {return("erocksdb.UInt64AddOperator");};
+
+};  // class UInt64AddOperator
+
+
+/**
+ * Append:  operand is appended to the existing value, separated
+ *  by the delimiter given at open time
+ */
+class AppendOperator : public rocksdb::AssociativeMergeOperator
+{
+protected:
+    std::string m_Delimiter;
+
+public:
+    explicit AppendOperator(const std::string & Delimiter) : m_Delimiter(Delimiter) {};
+
+    virtual bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existing_value,
+                       const rocksdb::Slice& value, std::string* new_value,
+                       rocksdb::Logger* logger) const;
+
+    virtual const char* Name() const {return("erocksdb.AppendOperator");};
+
+};  // class AppendOperator
+
+
+/**
+ * Sorted set union:  values and operands are sequences of
+ *  <<Len:32/big, Element:Len/binary>> in ascending byte order without
+ *  duplicates.  Merge fails on a malformed or unsorted operand.
+ */
+class SetUnionOperator : public rocksdb::AssociativeMergeOperator
+{
+public:
+    virtual bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existing_value,
+                       const rocksdb::Slice& value, std::string* new_value,
+                       rocksdb::Logger* logger) const;
+
+    virtual const char* Name() const {return("erocksdb.SetUnionOperator");};
+
+};  // class SetUnionOperator
+
+} // namespace erocksdb
+
+
+#endif  // INCL_MERGE_OPERATORS_H
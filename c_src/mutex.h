@@ -46,6 +46,8 @@ public:
 
     void Lock() {pthread_mutex_lock(&m_Mutex);};
 
+    bool TryLock() {return(0==pthread_mutex_trylock(&m_Mutex));};
+
     void Unlock() {pthread_mutex_unlock(&m_Mutex);};
 
 private:
@@ -0,0 +1,154 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+
+#ifndef INCL_RATE_LIMITER_H
+    #include "rate_limiter.h"
+#endif
+
+namespace erocksdb {
+
+AdjustableRateLimiter::AdjustableRateLimiter(
+    int64_t BytesPerSec)
+    : m_Inner(rocksdb::NewGenericRateLimiter(BytesPerSec)),
+      m_BytesPerSec(BytesPerSec)
+{
+    for (int loop=0; loop<rocksdb::Env::IO_TOTAL; ++loop)
+    {
+        m_RetiredBytes[loop]=0;
+        m_RetiredRequests[loop]=0;
+    }   // for
+
+}   // AdjustableRateLimiter::AdjustableRateLimiter
+
+
+void
+AdjustableRateLimiter::SetRate(
+    int64_t BytesPerSec)
+{
+    std::shared_ptr<rocksdb::RateLimiter> replacement(rocksdb::NewGenericRateLimiter(BytesPerSec));
+    MutexLock lock(m_Mutex);
+
+    for (int loop=0; loop<rocksdb::Env::IO_TOTAL; ++loop)
+    {
+        rocksdb::Env::IOPriority pri=(rocksdb::Env::IOPriority)loop;
+
+        m_RetiredBytes[loop]+=m_Inner->GetTotalBytesThrough(pri);
+        m_RetiredRequests[loop]+=m_Inner->GetTotalRequests(pri);
+    }   // for
+
+    m_Inner=replacement;
+    m_BytesPerSec=BytesPerSec;
+
+    return;
+
+}   // AdjustableRateLimiter::SetRate
+
+
+int64_t
+AdjustableRateLimiter::GetRate()
+{
+    MutexLock lock(m_Mutex);
+
+    return(m_BytesPerSec);
+
+}   // AdjustableRateLimiter::GetRate
+
+
+std::shared_ptr<rocksdb::RateLimiter>
+AdjustableRateLimiter::Current() const
+{
+    MutexLock lock(m_Mutex);
+
+    return(m_Inner);
+
+}   // AdjustableRateLimiter::Current
+
+
+void
+AdjustableRateLimiter::Request(
+    const int64_t bytes,
+    const rocksdb::Env::IOPriority pri)
+{
+    // may block, must not hold m_Mutex
+    Current()->Request(bytes, pri);
+
+    return;
+
+}   // AdjustableRateLimiter::Request
+
+
+int64_t
+AdjustableRateLimiter::GetSingleBurstBytes() const
+{
+    return(Current()->GetSingleBurstBytes());
+
+}   // AdjustableRateLimiter::GetSingleBurstBytes
+
+
+int64_t
+AdjustableRateLimiter::GetTotalBytesThrough(
+    const rocksdb::Env::IOPriority pri) const
+{
+    MutexLock lock(m_Mutex);
+    int64_t total;
+
+    total=m_Inner->GetTotalBytesThrough(pri);
+
+    if (rocksdb::Env::IO_TOTAL==pri)
+    {
+        for (int loop=0; loop<rocksdb::Env::IO_TOTAL; ++loop)
+            total+=m_RetiredBytes[loop];
+    }   // if
+    else
+    {
+        total+=m_RetiredBytes[pri];
+    }   // else
+
+    return(total);
+
+}   // AdjustableRateLimiter::GetTotalBytesThrough
+
+
+int64_t
+AdjustableRateLimiter::GetTotalRequests(
+    const rocksdb::Env::IOPriority pri) const
+{
+    MutexLock lock(m_Mutex);
+    int64_t total;
+
+    total=m_Inner->GetTotalRequests(pri);
+
+    if (rocksdb::Env::IO_TOTAL==pri)
+    {
+        for (int loop=0; loop<rocksdb::Env::IO_TOTAL; ++loop)
+            total+=m_RetiredRequests[loop];
+    }   // if
+    else
+    {
+        total+=m_RetiredRequests[pri];
+    }   // else
+
+    return(total);
+
+}   // AdjustableRateLimiter::GetTotalRequests
+
+} // namespace erocksdb
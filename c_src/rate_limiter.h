@@ -0,0 +1,82 @@
+// -------------------------------------------------------------------
+//
+// erocksdb: Erlang Wrapper for RocksDB (https://github.com/facebook/rocksdb)
+//
+// Copyright (c) 2012-2015 Rakuten, Inc.
+//
+// This file is provided to you under the Apache License,
+// Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License.  You may obtain
+// a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// -------------------------------------------------------------------
+#ifndef INCL_RATE_LIMITER_H
+#define INCL_RATE_LIMITER_H
+
+#include <stdint.h>
+#include <memory>
+
+#include "rocksdb/env.h"
+#include "rocksdb/rate_limiter.h"
+
+#ifndef INCL_MUTEX_H
+    #include "mutex.h"
+#endif
+
+namespace erocksdb {
+
+/**
+ * Rate limiter whose rate can change while databases use it.
+ *  rocksdb 3.11 generic limiters have a fixed rate, so this one
+ *  forwards to a generic limiter and replaces it on SetRate.
+ *  Requests already waiting in the old limiter finish there.
+ */
+class AdjustableRateLimiter : public rocksdb::RateLimiter
+{
+protected:
+    mutable Mutex m_Mutex;                          //!< protects members below
+    std::shared_ptr<rocksdb::RateLimiter> m_Inner;
+    int64_t m_BytesPerSec;
+    int64_t m_RetiredBytes[rocksdb::Env::IO_TOTAL];     //!< totals of replaced limiters
+    int64_t m_RetiredRequests[rocksdb::Env::IO_TOTAL];
+
+public:
+    explicit AdjustableRateLimiter(int64_t BytesPerSec);
+
+    virtual ~AdjustableRateLimiter() {};
+
+    void SetRate(int64_t BytesPerSec);
+
+    int64_t GetRate();
+
+    virtual void Request(const int64_t bytes, const rocksdb::Env::IOPriority pri);
+
+    virtual int64_t GetSingleBurstBytes() const;
+
+    virtual int64_t GetTotalBytesThrough(const rocksdb::Env::IOPriority pri = rocksdb::Env::IO_TOTAL) const;
+
+    virtual int64_t GetTotalRequests(const rocksdb::Env::IOPriority pri = rocksdb::Env::IO_TOTAL) const;
+
+protected:
+    std::shared_ptr<rocksdb::RateLimiter> Current() const;
+
+private:
+    AdjustableRateLimiter();
+    AdjustableRateLimiter(const AdjustableRateLimiter &);            // no copy
+    AdjustableRateLimiter & operator=(const AdjustableRateLimiter &); // no assignment
+
+};  // class AdjustableRateLimiter
+
+} // namespace erocksdb
+
+
+#endif  // INCL_RATE_LIMITER_H
@@ -210,7 +210,8 @@ DbObject::CreateDbObjectType(
 DbObject *
 DbObject::CreateDbObject(
     rocksdb::DB * Db,
-    rocksdb::Options * Options)
+    rocksdb::Options * Options,
+    const DbObjectOptions & ObjectOptions)
 {
     DbObject * ret_ptr;
     void * alloc_ptr;
@@ -218,7 +219,7 @@ DbObject::CreateDbObject(
     // the alloc call initializes the reference count to "one"
     alloc_ptr=enif_alloc_resource(m_Db_RESOURCE, sizeof(DbObject));
 
-    ret_ptr=new (alloc_ptr) DbObject(Db, Options);
+    ret_ptr=new (alloc_ptr) DbObject(Db, Options, ObjectOptions);
 
     // manual reference increase to keep active until "close" called
     //  only inc local counter, leave erl ref count alone ... will force
@@ -278,9 +279,17 @@ DbObject::DbObjectResourceCleanup(
 
 DbObject::DbObject(
     rocksdb::DB * DbPtr,
-    rocksdb::Options * Options)
-    : m_Db(DbPtr), m_DbOptions(Options)
+    rocksdb::Options * Options,
+    const DbObjectOptions & ObjectOptions)
+    : m_Db(DbPtr), m_DbOptions(Options), m_ObjectOptions(ObjectOptions),
+      m_CoalescedGets(0), m_NoReplyIssued(0), m_NoReplyWatermark(0), m_NoReplyNotified(0),
+      m_NoReplyFailed(0)
 {
+    size_t loop;
+
+    for (loop=0; loop<KEY_LOCK_STRIPES; ++loop)
+        m_KeyLockBusy[loop]=false;
+
 }   // DbObject::DbObject
 
 
@@ -369,6 +378,179 @@ DbObject::RemoveReference(
 }   // DbObject::RemoveReference
 
 
+uint64_t
+DbObject::IssueNoReplyTicket()
+{
+    MutexLock lock(m_WatermarkMutex);
+
+    return(++m_NoReplyIssued);
+
+}   // DbObject::IssueNoReplyTicket
+
+
+/**
+ * Called by worker thread once a noreply write finished.  Subscribers
+ *  hear of watermark moves in batches:  every WATERMARK_NOTIFY_INTERVAL
+ *  tickets, and whenever all issued tickets have completed.
+ */
+void
+DbObject::CompleteNoReplyWrite(
+    uint64_t Ticket,
+    bool Succeeded)
+{
+    MutexLock lock(m_WatermarkMutex);
+
+    if (!Succeeded)
+        ++m_NoReplyFailed;
+
+    if (m_NoReplyWatermark+1==Ticket)
+    {
+        m_NoReplyWatermark=Ticket;
+
+        // absorb tickets that completed out of order
+        while (!m_NoReplyDone.empty() && *m_NoReplyDone.begin()==m_NoReplyWatermark+1)
+        {
+            m_NoReplyWatermark=*m_NoReplyDone.begin();
+            m_NoReplyDone.erase(m_NoReplyDone.begin());
+        }   // while
+    }   // if
+    else
+    {
+        m_NoReplyDone.insert(Ticket);
+    }   // else
+
+    if (m_NoReplyNotified!=m_NoReplyWatermark
+        && (m_NoReplyIssued==m_NoReplyWatermark
+            || WATERMARK_NOTIFY_INTERVAL<=m_NoReplyWatermark-m_NoReplyNotified))
+    {
+        std::vector<ErlNifPid>::iterator it;
+
+        m_NoReplyNotified=m_NoReplyWatermark;
+
+        // a failed send means the subscriber died, drop it
+        for (it=m_NoReplySubscribers.begin(); m_NoReplySubscribers.end()!=it; )
+        {
+            ErlNifEnv * msg_env=enif_alloc_env();
+            ERL_NIF_TERM msg=enif_make_tuple3(msg_env, ATOM_WRITE_WATERMARK,
+                                              enif_make_uint64(msg_env, m_NoReplyWatermark),
+                                              enif_make_uint64(msg_env, m_NoReplyFailed));
+            int sent;
+
+            sent=enif_send(NULL, &(*it), msg_env, msg);
+            enif_free_env(msg_env);
+
+            if (sent)
+                ++it;
+            else
+                it=m_NoReplySubscribers.erase(it);
+        }   // for
+    }   // if
+
+    return;
+
+}   // DbObject::CompleteNoReplyWrite
+
+
+void
+DbObject::GetWriteWatermark(
+    uint64_t & Watermark,
+    uint64_t & Failed)
+{
+    MutexLock lock(m_WatermarkMutex);
+
+    Watermark=m_NoReplyWatermark;
+    Failed=m_NoReplyFailed;
+
+    return;
+
+}   // DbObject::GetWriteWatermark
+
+
+void
+DbObject::SubscribeWriteWatermark(
+    const ErlNifPid & Pid)
+{
+    MutexLock lock(m_WatermarkMutex);
+    std::vector<ErlNifPid>::iterator it;
+
+    for (it=m_NoReplySubscribers.begin(); m_NoReplySubscribers.end()!=it; ++it)
+        if (it->pid==Pid.pid)
+            return;
+
+    m_NoReplySubscribers.push_back(Pid);
+
+    return;
+
+}   // DbObject::SubscribeWriteWatermark
+
+
+void
+DbObject::UnsubscribeWriteWatermark(
+    const ErlNifPid & Pid)
+{
+    MutexLock lock(m_WatermarkMutex);
+    std::vector<ErlNifPid>::iterator it;
+
+    for (it=m_NoReplySubscribers.begin(); m_NoReplySubscribers.end()!=it; ++it)
+    {
+        if (it->pid==Pid.pid)
+        {
+            m_NoReplySubscribers.erase(it);
+            break;
+        }   // if
+    }   // for
+
+    return;
+
+}   // DbObject::UnsubscribeWriteWatermark
+
+
+bool
+DbObject::KeyLockAcquire(
+    size_t Stripe,
+    WorkTask * Task)
+{
+    MutexLock lock(m_KeyLockMutex);
+
+    if (!m_KeyLockBusy[Stripe])
+    {
+        m_KeyLockBusy[Stripe]=true;
+        return(true);
+    }   // if
+
+    Task->RefInc();
+    m_KeyLockWaiters[Stripe].push_back(Task);
+
+    return(false);
+
+}   // DbObject::KeyLockAcquire
+
+
+WorkTask *
+DbObject::KeyLockRelease(
+    size_t Stripe)
+{
+    MutexLock lock(m_KeyLockMutex);
+    WorkTask * next;
+
+    next=NULL;
+
+    // the stripe stays busy, ownership passes to the waiter
+    if (!m_KeyLockWaiters[Stripe].empty())
+    {
+        next=m_KeyLockWaiters[Stripe].front();
+        m_KeyLockWaiters[Stripe].pop_front();
+    }   // if
+    else
+    {
+        m_KeyLockBusy[Stripe]=false;
+    }   // else
+
+    return(next);
+
+}   // DbObject::KeyLockRelease
+
+
 /**
  * Iterator management object
  */
@@ -526,6 +708,580 @@ ItrObject::ReleaseReuseMove()
 }   // ItrObject::ReleaseReuseMove()
 
 
+/**
+ * Value buffer object
+ */
+
+ErlNifResourceType * ValueObject::m_Value_RESOURCE(NULL);
+
+
+void
+ValueObject::CreateValueObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_Value_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_ValueObject",
+                                               &ValueObject::ValueObjectResourceCleanup,
+                                               flags, NULL);
+
+    return;
+
+}   // ValueObject::CreateValueObjectType
+
+
+ValueObject *
+ValueObject::CreateValueObject()
+{
+    ValueObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one"
+    alloc_ptr=enif_alloc_resource(m_Value_RESOURCE, sizeof(ValueObject));
+
+    ret_ptr=new (alloc_ptr) ValueObject();
+
+    // see ValueObject::MakeBinary() for release of reference count
+
+    return(ret_ptr);
+
+}   // ValueObject::CreateValueObject
+
+
+ERL_NIF_TERM
+ValueObject::MakeBinary(
+    ErlNifEnv * Env)
+{
+    ERL_NIF_TERM ret_term;
+
+    // binary holds its own reference to this resource
+    ret_term=enif_make_resource_binary(Env, this, m_Value.data(), m_Value.size());
+
+    // release reference created during CreateValueObject(),
+    //  "this" may be gone after this call if binary already dropped
+    enif_release_resource(this);
+
+    return(ret_term);
+
+}   // ValueObject::MakeBinary
+
+
+void
+ValueObject::ValueObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    ValueObject * value_ptr;
+
+    value_ptr=(ValueObject *)Arg;
+
+    // destruct only, erlang deallocates memory
+    value_ptr->~ValueObject();
+
+    return;
+
+}   // ValueObject::ValueObjectResourceCleanup
+
+
+/**
+ * Shared cache object
+ */
+
+ErlNifResourceType * CacheObject::m_Cache_RESOURCE(NULL);
+
+
+void
+CacheObject::CreateCacheObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_Cache_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_CacheObject",
+                                               &CacheObject::CacheObjectResourceCleanup,
+                                               flags, NULL);
+
+    return;
+
+}   // CacheObject::CreateCacheObjectType
+
+
+CacheObject::CacheObject(
+    size_t Capacity,
+    int NumShardBits)
+    : m_Cache(rocksdb::NewLRUCache(Capacity, NumShardBits)),
+      m_Statistics(rocksdb::CreateDBStatistics())
+{
+}   // CacheObject::CacheObject
+
+
+CacheObject *
+CacheObject::CreateCacheObject(
+    size_t Capacity,
+    int NumShardBits)
+{
+    CacheObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_Cache_RESOURCE, sizeof(CacheObject));
+
+    ret_ptr=new (alloc_ptr) CacheObject(Capacity, NumShardBits);
+
+    return(ret_ptr);
+
+}   // CacheObject::CreateCacheObject
+
+
+CacheObject *
+CacheObject::RetrieveCacheObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & CacheTerm)
+{
+    CacheObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, CacheTerm, m_Cache_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // CacheObject::RetrieveCacheObject
+
+
+void
+CacheObject::CacheObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    CacheObject * cache_ptr;
+
+    cache_ptr=(CacheObject *)Arg;
+
+    // destruct only, erlang deallocates memory.  Open databases
+    //  keep their own shared_ptr to the cache
+    cache_ptr->~CacheObject();
+
+    return;
+
+}   // CacheObject::CacheObjectResourceCleanup
+
+
+/**
+ * Rate limiter object
+ */
+
+ErlNifResourceType * RateLimiterObject::m_RateLimiter_RESOURCE(NULL);
+
+
+void
+RateLimiterObject::CreateRateLimiterObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_RateLimiter_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_RateLimiterObject",
+                                                     &RateLimiterObject::RateLimiterObjectResourceCleanup,
+                                                     flags, NULL);
+
+    return;
+
+}   // RateLimiterObject::CreateRateLimiterObjectType
+
+
+RateLimiterObject *
+RateLimiterObject::CreateRateLimiterObject(
+    int64_t BytesPerSec)
+{
+    RateLimiterObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_RateLimiter_RESOURCE, sizeof(RateLimiterObject));
+
+    ret_ptr=new (alloc_ptr) RateLimiterObject(BytesPerSec);
+
+    return(ret_ptr);
+
+}   // RateLimiterObject::CreateRateLimiterObject
+
+
+RateLimiterObject *
+RateLimiterObject::RetrieveRateLimiterObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & LimiterTerm)
+{
+    RateLimiterObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, LimiterTerm, m_RateLimiter_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // RateLimiterObject::RetrieveRateLimiterObject
+
+
+void
+RateLimiterObject::RateLimiterObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    RateLimiterObject * limiter_ptr;
+
+    limiter_ptr=(RateLimiterObject *)Arg;
+
+    // destruct only, erlang deallocates memory.  Open databases
+    //  keep their own shared_ptr to the limiter
+    limiter_ptr->~RateLimiterObject();
+
+    return;
+
+}   // RateLimiterObject::RateLimiterObjectResourceCleanup
+
+
+/**
+ * Read options object
+ */
+
+ErlNifResourceType * ReadOptionsObject::m_ReadOptions_RESOURCE(NULL);
+
+
+void
+ReadOptionsObject::CreateReadOptionsObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_ReadOptions_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_ReadOptionsObject",
+                                                     &ReadOptionsObject::ReadOptionsObjectResourceCleanup,
+                                                     flags, NULL);
+
+    return;
+
+}   // ReadOptionsObject::CreateReadOptionsObjectType
+
+
+ReadOptionsObject *
+ReadOptionsObject::CreateReadOptionsObject()
+{
+    ReadOptionsObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_ReadOptions_RESOURCE, sizeof(ReadOptionsObject));
+
+    ret_ptr=new (alloc_ptr) ReadOptionsObject();
+
+    return(ret_ptr);
+
+}   // ReadOptionsObject::CreateReadOptionsObject
+
+
+ReadOptionsObject *
+ReadOptionsObject::RetrieveReadOptionsObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & OptionsTerm)
+{
+    ReadOptionsObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, OptionsTerm, m_ReadOptions_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // ReadOptionsObject::RetrieveReadOptionsObject
+
+
+void
+ReadOptionsObject::ReadOptionsObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    ReadOptionsObject * opts_ptr;
+
+    opts_ptr=(ReadOptionsObject *)Arg;
+
+    // destruct only, erlang deallocates memory
+    opts_ptr->~ReadOptionsObject();
+
+    return;
+
+}   // ReadOptionsObject::ReadOptionsObjectResourceCleanup
+
+
+/**
+ * Write options object
+ */
+
+ErlNifResourceType * WriteOptionsObject::m_WriteOptions_RESOURCE(NULL);
+
+
+void
+WriteOptionsObject::CreateWriteOptionsObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_WriteOptions_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_WriteOptionsObject",
+                                                      &WriteOptionsObject::WriteOptionsObjectResourceCleanup,
+                                                      flags, NULL);
+
+    return;
+
+}   // WriteOptionsObject::CreateWriteOptionsObjectType
+
+
+WriteOptionsObject *
+WriteOptionsObject::CreateWriteOptionsObject()
+{
+    WriteOptionsObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_WriteOptions_RESOURCE, sizeof(WriteOptionsObject));
+
+    ret_ptr=new (alloc_ptr) WriteOptionsObject();
+
+    return(ret_ptr);
+
+}   // WriteOptionsObject::CreateWriteOptionsObject
+
+
+WriteOptionsObject *
+WriteOptionsObject::RetrieveWriteOptionsObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & OptionsTerm)
+{
+    WriteOptionsObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, OptionsTerm, m_WriteOptions_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // WriteOptionsObject::RetrieveWriteOptionsObject
+
+
+void
+WriteOptionsObject::WriteOptionsObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    WriteOptionsObject * opts_ptr;
+
+    opts_ptr=(WriteOptionsObject *)Arg;
+
+    // destruct only, erlang deallocates memory
+    opts_ptr->~WriteOptionsObject();
+
+    return;
+
+}   // WriteOptionsObject::WriteOptionsObjectResourceCleanup
+
+
+/**
+ * Write batch object
+ */
+
+ErlNifResourceType * BatchObject::m_Batch_RESOURCE(NULL);
+
+
+void
+BatchObject::CreateBatchObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_Batch_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_BatchObject",
+                                               &BatchObject::BatchObjectResourceCleanup,
+                                               flags, NULL);
+
+    return;
+
+}   // BatchObject::CreateBatchObjectType
+
+
+BatchObject *
+BatchObject::CreateBatchObject()
+{
+    BatchObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_Batch_RESOURCE, sizeof(BatchObject));
+
+    ret_ptr=new (alloc_ptr) BatchObject();
+
+    return(ret_ptr);
+
+}   // BatchObject::CreateBatchObject
+
+
+BatchObject *
+BatchObject::RetrieveBatchObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & BatchTerm)
+{
+    BatchObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, BatchTerm, m_Batch_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // BatchObject::RetrieveBatchObject
+
+
+void
+BatchObject::BatchObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    BatchObject * batch_ptr;
+
+    batch_ptr=(BatchObject *)Arg;
+
+    // destruct only, erlang deallocates memory
+    batch_ptr->~BatchObject();
+
+    return;
+
+}   // BatchObject::BatchObjectResourceCleanup
+
+
+/**
+ * StreamObject Functions
+ */
+
+ErlNifResourceType * StreamObject::m_Stream_RESOURCE(NULL);
+
+
+void
+StreamObject::CreateStreamObjectType(
+    ErlNifEnv * Env)
+{
+    ErlNifResourceFlags flags = (ErlNifResourceFlags)(ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER);
+
+    m_Stream_RESOURCE = enif_open_resource_type(Env, NULL, "erocksdb_StreamObject",
+                                                &StreamObject::StreamObjectResourceCleanup,
+                                                flags, NULL);
+
+    return;
+
+}   // StreamObject::CreateStreamObjectType
+
+
+StreamObject::StreamObject(
+    ItrObject * Itr,
+    const rocksdb::Slice & Start,
+    const rocksdb::Slice * End,
+    const ErlNifPid & Pid,
+    unsigned ChunkSize)
+    : m_Itr(Itr), m_Start(Start.data(), Start.size()), m_HasEnd(NULL!=End),
+      m_Pid(Pid), m_ChunkSize(ChunkSize), m_Credits(0), m_Running(false),
+      m_Positioned(false), m_Done(false)
+{
+    if (NULL!=End)
+        m_End.assign(End->data(), End->size());
+
+    enif_keep_resource(m_Itr);
+
+    return;
+
+}   // StreamObject::StreamObject
+
+
+StreamObject::~StreamObject()
+{
+    Close();
+    enif_release_resource(m_Itr);
+
+    return;
+
+}   // StreamObject::~StreamObject
+
+
+void
+StreamObject::Close()
+{
+    // safe to repeat, only the first request shuts the ItrObject down
+    ItrObject::InitiateCloseRequest(m_Itr);
+
+    return;
+
+}   // StreamObject::Close
+
+
+StreamObject *
+StreamObject::CreateStreamObject(
+    ItrObject * Itr,
+    const rocksdb::Slice & Start,
+    const rocksdb::Slice * End,
+    const ErlNifPid & Pid,
+    unsigned ChunkSize)
+{
+    StreamObject * ret_ptr;
+    void * alloc_ptr;
+
+    // the alloc call initializes the reference count to "one",
+    //  caller releases it after enif_make_resource()
+    alloc_ptr=enif_alloc_resource(m_Stream_RESOURCE, sizeof(StreamObject));
+
+    ret_ptr=new (alloc_ptr) StreamObject(Itr, Start, End, Pid, ChunkSize);
+
+    return(ret_ptr);
+
+}   // StreamObject::CreateStreamObject
+
+
+StreamObject *
+StreamObject::RetrieveStreamObject(
+    ErlNifEnv * Env,
+    const ERL_NIF_TERM & StreamTerm)
+{
+    StreamObject * ret_ptr;
+
+    ret_ptr=NULL;
+
+    if (!enif_get_resource(Env, StreamTerm, m_Stream_RESOURCE, (void **)&ret_ptr))
+        ret_ptr=NULL;
+
+    return(ret_ptr);
+
+}   // StreamObject::RetrieveStreamObject
+
+
+void
+StreamObject::StreamObjectResourceCleanup(
+    ErlNifEnv * Env,
+    void * Arg)
+{
+    StreamObject * stream_ptr;
+
+    stream_ptr=(StreamObject *)Arg;
+
+    // destruct only, erlang deallocates memory.  A StreamTask
+    //  holds a resource reference so none is active here
+    stream_ptr->~StreamObject();
+
+    return;
+
+}   // StreamObject::StreamObjectResourceCleanup
+
+
 } // namespace erocksdb
 
 
@@ -24,10 +24,19 @@
 #define INCL_REFOBJECTS_H
 
 #include <stdint.h>
+#include <atomic>
+#include <deque>
 #include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "rocksdb/db.h"
 #include "rocksdb/write_batch.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/statistics.h"
 
 #ifndef INCL_THREADING_H
     #include "threading.h"
@@ -41,6 +50,14 @@
     #include "atoms.h"
 #endif
 
+#ifndef INCL_RATE_LIMITER_H
+    #include "rate_limiter.h"
+#endif
+
+#ifndef INCL_EVENT_LISTENER_H
+    #include "event_listener.h"
+#endif
+
 
 namespace erocksdb {
 
@@ -166,6 +183,43 @@ private:
 };  // ReferencePtr
 
 
+// noreply write tickets completed between watermark notifications
+const uint64_t WATERMARK_NOTIFY_INTERVAL = 256;
+
+// striped per key locks of put_if
+const size_t KEY_LOCK_STRIPES = 64;
+
+// new_cache shard bits are below this
+const int CACHE_MAX_SHARD_BITS = 20;
+
+// keys_may_exist probes at most this many keys inline per call
+const unsigned KEYS_MAY_EXIST_MAX = 1024;
+
+
+/**
+ * erocksdb specific settings of a database, parsed at open time
+ *  from the same list as rocksdb::Options
+ */
+struct DbObjectOptions
+{
+    bool m_CoalesceGets;                      //!< concurrent gets of one key share one GetTask
+    std::atomic<bool> m_BulkLoad;             //!< writes skip the WAL until finish_bulk_load
+    std::unordered_map<std::string, std::string> m_BulkLoadRestore; //!< SetOptions values bulk_load replaced
+    std::shared_ptr<ErlangEventListener> m_EventListener; //!< also in rocksdb::Options::listeners
+
+    DbObjectOptions()
+        : m_CoalesceGets(false), m_BulkLoad(false)
+    {};
+
+    // std::atomic has no copy constructor
+    DbObjectOptions(const DbObjectOptions & Other)
+        : m_CoalesceGets(Other.m_CoalesceGets), m_BulkLoad(Other.m_BulkLoad.load()),
+          m_BulkLoadRestore(Other.m_BulkLoadRestore),
+          m_EventListener(Other.m_EventListener)
+    {};
+};  // struct DbObjectOptions
+
+
 /**
  * Per database object.  Created as erlang reference.
  *
@@ -178,14 +232,39 @@ public:
 
     rocksdb::Options *m_DbOptions;
 
+    DbObjectOptions m_ObjectOptions;
+
     Mutex m_ItrMutex;                         //!< mutex protecting m_ItrList
     std::list<class ItrObject *> m_ItrList;   //!< ItrObjects holding ref count to this
 
+    Mutex m_InFlightMutex;                    //!< mutex protecting m_InFlightGets
+    std::map<std::string, class GetTask *> m_InFlightGets; //!< queued, not yet started gets by GetTask::InFlightKey
+    uint64_t m_CoalescedGets;                 //!< gets answered by another caller's GetTask, under m_InFlightMutex
+
+    // noreply writes:  tickets are issued in submit order, the
+    //  watermark is the highest ticket with every ticket at or below
+    //  it completed
+    Mutex m_WatermarkMutex;                   //!< mutex protecting the m_NoReply* members
+    uint64_t m_NoReplyIssued;                 //!< last ticket handed out
+    uint64_t m_NoReplyWatermark;
+    uint64_t m_NoReplyNotified;               //!< watermark last sent to subscribers
+    uint64_t m_NoReplyFailed;                 //!< completed writes that returned an error
+    std::set<uint64_t> m_NoReplyDone;         //!< completed tickets above the watermark
+    std::vector<ErlNifPid> m_NoReplySubscribers;
+
+    // put_if serializes on key stripes.  Waiters are parked instead of
+    //  holding a worker thread, the owner hands the stripe to the first
+    //  one when done
+    Mutex m_KeyLockMutex;                     //!< mutex protecting the m_KeyLock* members
+    bool m_KeyLockBusy[KEY_LOCK_STRIPES];
+    std::deque<class WorkTask *> m_KeyLockWaiters[KEY_LOCK_STRIPES]; //!< each holds a reference
+
 protected:
     static ErlNifResourceType* m_Db_RESOURCE;
 
 public:
-    DbObject(rocksdb::DB * DbPtr, rocksdb::Options * Options); // Open with default CF
+    DbObject(rocksdb::DB * DbPtr, rocksdb::Options * Options,
+             const DbObjectOptions & ObjectOptions); // Open with default CF
 
     virtual ~DbObject();
 
@@ -196,9 +275,29 @@ public:
 
     void RemoveReference(class ItrObject *);
 
+    uint64_t IssueNoReplyTicket();
+
+    void CompleteNoReplyWrite(uint64_t Ticket, bool Succeeded);
+
+    void GetWriteWatermark(uint64_t & Watermark, uint64_t & Failed);
+
+    void SubscribeWriteWatermark(const ErlNifPid & Pid);
+
+    void UnsubscribeWriteWatermark(const ErlNifPid & Pid);
+
+    size_t KeyStripe(const std::string & Key)
+        {return(std::hash<std::string>()(Key) % KEY_LOCK_STRIPES);};
+
+    // true if Task now owns Stripe, else Task is parked with a reference
+    bool KeyLockAcquire(size_t Stripe, class WorkTask * Task);
+
+    // returns the parked task that now owns Stripe, or NULL
+    class WorkTask * KeyLockRelease(size_t Stripe);
+
     static void CreateDbObjectType(ErlNifEnv * Env);
 
-    static DbObject * CreateDbObject(rocksdb::DB * Db, rocksdb::Options* Options);
+    static DbObject * CreateDbObject(rocksdb::DB * Db, rocksdb::Options* Options,
+                                     const DbObjectOptions & ObjectOptions);
 
     static DbObject * RetrieveDbObject(ErlNifEnv * Env, const ERL_NIF_TERM & DbTerm);
 
@@ -211,6 +310,23 @@ private:
 };  // class DbObject
 
 
+/**
+ * Iterator bounds from the iterate_lower_bound and iterate_upper_bound
+ *  read options.  rocksdb::ReadOptions only points at the upper bound,
+ *  the bytes are copied here and then into the RocksIteratorWrapper
+ *  so they live exactly as long as the rocksdb iterator
+ */
+struct IterateBounds
+{
+    std::string m_Lower;
+    std::string m_Upper;
+    bool m_HasLower;
+    bool m_HasUpper;
+
+    IterateBounds() : m_HasLower(false), m_HasUpper(false) {};
+};  // struct IterateBounds
+
+
 /**
  * A self deleting wrapper to contain rocksdb snapshot pointer.
  *   Needed because multiple RocksIteratorWrappers could be using
@@ -223,21 +339,13 @@ public:
     ReferencePtr<DbObject> m_DbPtr;  //!< need to keep db open for delete of this object
     const rocksdb::Snapshot * m_Snapshot;
 
-    // this is an odd place to put this info, but it
-    //  happens to have the exact same lifespan
-    ERL_NIF_TERM itr_ref;
-    ErlNifEnv *itr_ref_env;
-
     RocksSnapshotWrapper(DbObject * DbPtr, const rocksdb::Snapshot * Snapshot)
-        : m_DbPtr(DbPtr), m_Snapshot(Snapshot), itr_ref_env(NULL)
+        : m_DbPtr(DbPtr), m_Snapshot(Snapshot)
     {
     };
 
     virtual ~RocksSnapshotWrapper()
     {
-        if (NULL!=itr_ref_env)
-            enif_free_env(itr_ref_env);
-
         if (NULL!=m_Snapshot)
         {
             // rocksdb performs actual "delete" call on m_Shapshot's pointer
@@ -270,19 +378,54 @@ public:
     ReferencePtr<DbObject> m_DbPtr;           //!< need to keep db open for delete of this object
     ReferencePtr<RocksSnapshotWrapper> m_Snap;//!< keep snapshot active while this object is
     rocksdb::Iterator * m_Iterator;
+    rocksdb::Iterator * m_LastIterator;       //!< unbounded twin SeekToLast probes with, created on first use
     volatile uint32_t m_HandoffAtomic;        //!< matthew's atomic foreground/background prefetch flag.
     bool m_KeysOnly;                          //!< only return key values
     bool m_PrefetchStarted;                   //!< true after first prefetch command
+    IterateBounds m_Bounds;                   //!< owns the bound bytes
+    rocksdb::Slice m_UpperSlice;              //!< ReadOptions::iterate_upper_bound points here
+    rocksdb::ReadOptions m_LastOptions;       //!< m_Iterator's options without the upper bound
+    Mutex m_IterMutex;                        //!< one MoveTask at a time on m_Iterator
+    bool m_Ahead;                             //!< parked prefetch is one entry past erlang
+    uint32_t m_NextStreak;                    //!< consecutive single next calls
+    volatile uint32_t m_PrefetchGeneration;   //!< bumped when erlang leaves prefetch mode
+
+    // caller ref of the iterator call, reused by every iterator_move.
+    //  Lives here since several iterators can share one snapshot
+    ERL_NIF_TERM itr_ref;
+    ErlNifEnv *itr_ref_env;
 
     RocksIteratorWrapper(DbObject * DbPtr, RocksSnapshotWrapper * Snapshot,
                          rocksdb::Iterator * Iterator, bool KeysOnly)
-        : m_DbPtr(DbPtr), m_Snap(Snapshot), m_Iterator(Iterator),
-        m_HandoffAtomic(0), m_KeysOnly(KeysOnly), m_PrefetchStarted(false)
+        : m_DbPtr(DbPtr), m_Snap(Snapshot), m_Iterator(Iterator), m_LastIterator(NULL),
+        m_HandoffAtomic(0), m_KeysOnly(KeysOnly), m_PrefetchStarted(false),
+        m_Ahead(false), m_NextStreak(0), m_PrefetchGeneration(0),
+        itr_ref_env(NULL)
     {
     };
 
+    // copy the bounds and point Options at them, call after Options
+    //  is otherwise complete and before creating m_Iterator
+    void SetBounds(const IterateBounds & Bounds, rocksdb::ReadOptions & Options)
+    {
+        m_Bounds=Bounds;
+        m_UpperSlice=rocksdb::Slice(m_Bounds.m_Upper);
+        m_LastOptions=Options;
+        m_LastOptions.iterate_upper_bound=NULL;
+        Options.iterate_upper_bound=(m_Bounds.m_HasUpper ? &m_UpperSlice : NULL);
+    };
+
     virtual ~RocksIteratorWrapper()
     {
+        if (NULL!=itr_ref_env)
+            enif_free_env(itr_ref_env);
+
+        if (NULL!=m_LastIterator)
+        {
+            delete m_LastIterator;
+            m_LastIterator=NULL;
+        }   // if
+
         if (NULL!=m_Iterator)
         {
             delete m_Iterator;
@@ -293,10 +436,84 @@ public:
     rocksdb::Iterator * get() {return(m_Iterator);};
     rocksdb::Iterator * operator->() {return(m_Iterator);};
 
-    bool Valid() {return(m_Iterator->Valid());};
+    // rocksdb stops forward moves at the upper bound.  It has no lower
+    //  bound and SeekToLast/Prev ignore the upper one, so both are also
+    //  checked here
+    bool Valid()
+    {
+        return(m_Iterator->Valid()
+               && (!m_Bounds.m_HasLower || 0<=m_Iterator->key().compare(m_Bounds.m_Lower))
+               && (!m_Bounds.m_HasUpper || 0>m_Iterator->key().compare(m_UpperSlice)));
+    };
     rocksdb::Slice key() {return(m_Iterator->key());};
     rocksdb::Slice value() {return(m_Iterator->value());};
 
+    void SeekToFirst()
+    {
+        if (m_Bounds.m_HasLower)
+            m_Iterator->Seek(m_Bounds.m_Lower);
+        else
+            m_Iterator->SeekToFirst();
+    };
+
+    // rocksdb's SeekToLast ignores the upper bound and it cannot Prev()
+    //  from the invalid position a bounded Seek(upper) leaves.  The
+    //  unbounded twin finds the last key below the bound in one Seek
+    //  and Prev, m_Iterator then seeks straight to it
+    void SeekToLast()
+    {
+        if (m_Bounds.m_HasUpper)
+        {
+            if (NULL==m_LastIterator)
+                m_LastIterator=m_DbPtr->m_Db->NewIterator(m_LastOptions);
+
+            m_LastIterator->Seek(m_UpperSlice);
+            if (m_LastIterator->Valid())
+            {
+                m_LastIterator->Prev();
+                if (m_LastIterator->Valid())
+                    m_Iterator->Seek(m_LastIterator->key());
+                else
+                    m_Iterator->SeekToFirst();  // nothing below the bound, leaves m_Iterator invalid
+            }   // if
+            else
+            {
+                // no key at or past the bound
+                m_Iterator->SeekToLast();
+            }   // else
+        }   // if
+        else
+        {
+            m_Iterator->SeekToLast();
+        }   // else
+    };
+
+    void Seek(const rocksdb::Slice & Target)
+    {
+        if (m_Bounds.m_HasLower && 0>Target.compare(m_Bounds.m_Lower))
+            m_Iterator->Seek(m_Bounds.m_Lower);
+        else
+            m_Iterator->Seek(Target);
+    };
+
+    // return to the entry erlang last received before any other move.
+    //  A parked prefetch stepped once past it, possibly off the end.
+    //  Caller holds m_IterMutex
+    void DropPrefetch()
+    {
+        if (m_Ahead)
+        {
+            if (m_Iterator->Valid())
+                m_Iterator->Prev();
+            else
+                SeekToLast();
+
+            m_Ahead=false;
+        }   // if
+
+        m_HandoffAtomic=0;
+    };
+
 private:
     RocksIteratorWrapper(const RocksIteratorWrapper &);            // no copy
     RocksIteratorWrapper& operator=(const RocksIteratorWrapper &); // no assignment
@@ -349,6 +566,258 @@ private:
     ItrObject & operator=(const ItrObject &); // no assignment
 };  // class ItrObject
 
+
+/**
+ * Holder for a value read from rocksdb.  Created as erlang resource
+ *  so the value bytes can be returned via enif_make_resource_binary
+ *  instead of being copied a second time into a fresh binary.
+ *  The erlang binary keeps this object alive.
+ */
+class ValueObject
+{
+public:
+    std::string m_Value;                      //!< rocksdb writes directly into this buffer
+
+protected:
+    static ErlNifResourceType* m_Value_RESOURCE;
+
+public:
+    ValueObject() {};
+
+    ~ValueObject() {};
+
+    // hand value to erlang as a binary, releases creation reference
+    ERL_NIF_TERM MakeBinary(ErlNifEnv * Env);
+
+    static void CreateValueObjectType(ErlNifEnv * Env);
+
+    static ValueObject * CreateValueObject();
+
+    static void ValueObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    ValueObject(const ValueObject &);            // no copy
+    ValueObject & operator=(const ValueObject &); // no assignment
+};  // class ValueObject
+
+
+/**
+ * Process wide cache, created as erlang resource so one cache
+ *  can be handed to many open calls.  Databases opened with it
+ *  share the cache and its hit/miss statistics.  Open databases
+ *  hold their own shared_ptr, so the cache outlives this resource
+ *  as long as needed.
+ */
+class CacheObject
+{
+public:
+    std::shared_ptr<rocksdb::Cache> m_Cache;
+    std::shared_ptr<rocksdb::Statistics> m_Statistics; //!< hit/miss counters of users with block_cache_statistics
+
+protected:
+    static ErlNifResourceType* m_Cache_RESOURCE;
+
+public:
+    CacheObject(size_t Capacity, int NumShardBits);
+
+    ~CacheObject() {};
+
+    static void CreateCacheObjectType(ErlNifEnv * Env);
+
+    static CacheObject * CreateCacheObject(size_t Capacity, int NumShardBits);
+
+    static CacheObject * RetrieveCacheObject(ErlNifEnv * Env, const ERL_NIF_TERM & CacheTerm);
+
+    static void CacheObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    CacheObject();
+    CacheObject(const CacheObject &);            // no copy
+    CacheObject & operator=(const CacheObject &); // no assignment
+};  // class CacheObject
+
+
+/**
+ * Rate limiter for flush and compaction I/O, shareable by many
+ *  open calls and adjustable at runtime.  Open databases hold
+ *  their own shared_ptr.
+ */
+class RateLimiterObject
+{
+public:
+    std::shared_ptr<AdjustableRateLimiter> m_Limiter;
+
+protected:
+    static ErlNifResourceType* m_RateLimiter_RESOURCE;
+
+public:
+    explicit RateLimiterObject(int64_t BytesPerSec)
+        : m_Limiter(std::make_shared<AdjustableRateLimiter>(BytesPerSec)) {};
+
+    ~RateLimiterObject() {};
+
+    static void CreateRateLimiterObjectType(ErlNifEnv * Env);
+
+    static RateLimiterObject * CreateRateLimiterObject(int64_t BytesPerSec);
+
+    static RateLimiterObject * RetrieveRateLimiterObject(ErlNifEnv * Env, const ERL_NIF_TERM & LimiterTerm);
+
+    static void RateLimiterObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    RateLimiterObject();
+    RateLimiterObject(const RateLimiterObject &);            // no copy
+    RateLimiterObject & operator=(const RateLimiterObject &); // no assignment
+};  // class RateLimiterObject
+
+
+/**
+ * Read options parsed once by read_options/1.  Immutable after
+ *  creation, calls copy m_Options instead of folding a list.
+ */
+class ReadOptionsObject
+{
+public:
+    rocksdb::ReadOptions m_Options;
+    bool m_ZeroCopy;            //!< erocksdb flag, not a rocksdb option
+    IterateBounds m_Bounds;     //!< copied by iterators, m_Options never points here
+
+protected:
+    static ErlNifResourceType* m_ReadOptions_RESOURCE;
+
+public:
+    ReadOptionsObject() : m_ZeroCopy(false) {};
+
+    ~ReadOptionsObject() {};
+
+    static void CreateReadOptionsObjectType(ErlNifEnv * Env);
+
+    static ReadOptionsObject * CreateReadOptionsObject();
+
+    static ReadOptionsObject * RetrieveReadOptionsObject(ErlNifEnv * Env, const ERL_NIF_TERM & OptionsTerm);
+
+    static void ReadOptionsObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    ReadOptionsObject(const ReadOptionsObject &);            // no copy
+    ReadOptionsObject & operator=(const ReadOptionsObject &); // no assignment
+};  // class ReadOptionsObject
+
+
+/**
+ * Write options parsed once by write_options/1, see ReadOptionsObject
+ */
+class WriteOptionsObject
+{
+public:
+    rocksdb::WriteOptions m_Options;
+    bool m_NoReply;             //!< erocksdb flags, not rocksdb options
+    bool m_CompactRange;
+
+protected:
+    static ErlNifResourceType* m_WriteOptions_RESOURCE;
+
+public:
+    WriteOptionsObject() : m_NoReply(false), m_CompactRange(false) {};
+
+    ~WriteOptionsObject() {};
+
+    static void CreateWriteOptionsObjectType(ErlNifEnv * Env);
+
+    static WriteOptionsObject * CreateWriteOptionsObject();
+
+    static WriteOptionsObject * RetrieveWriteOptionsObject(ErlNifEnv * Env, const ERL_NIF_TERM & OptionsTerm);
+
+    static void WriteOptionsObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    WriteOptionsObject(const WriteOptionsObject &);            // no copy
+    WriteOptionsObject & operator=(const WriteOptionsObject &); // no assignment
+};  // class WriteOptionsObject
+
+
+/**
+ * Write batch built incrementally by Erlang calls and committed
+ *  with write_batch without re-parsing an action list
+ */
+class BatchObject
+{
+public:
+    rocksdb::WriteBatch m_Batch;
+    Mutex m_BatchMutex;        //!< calls from different schedulers
+
+protected:
+    static ErlNifResourceType* m_Batch_RESOURCE;
+
+public:
+    BatchObject() {};
+
+    ~BatchObject() {};
+
+    static void CreateBatchObjectType(ErlNifEnv * Env);
+
+    static BatchObject * CreateBatchObject();
+
+    static BatchObject * RetrieveBatchObject(ErlNifEnv * Env, const ERL_NIF_TERM & BatchTerm);
+
+    static void BatchObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    BatchObject(const BatchObject &);            // no copy
+    BatchObject & operator=(const BatchObject &); // no assignment
+};  // class BatchObject
+
+
+/**
+ * Credit based export of a key range to a consumer process.  Owns an
+ *  ItrObject so a database close still shuts the scan down.  A StreamTask
+ *  sends one chunk per credit and stops when credits run out, the paused
+ *  stream then holds nothing but the iterator.
+ */
+class StreamObject
+{
+public:
+    ItrObject * m_Itr;          //!< holds a resource reference, closed when the stream ends
+    std::string m_Start;
+    std::string m_End;
+    bool m_HasEnd;              //!< false streams to the last key
+    ErlNifPid m_Pid;            //!< consumer
+    unsigned m_ChunkSize;       //!< entries per message
+
+    Mutex m_StreamMutex;        //!< stream_ack calls and the StreamTask
+    uint64_t m_Credits;         //!< messages the consumer still accepts
+    bool m_Running;             //!< a StreamTask is queued or working
+    bool m_Positioned;          //!< iterator sits on the next entry to send
+    bool m_Done;                //!< end reached, error or closed
+
+protected:
+    static ErlNifResourceType* m_Stream_RESOURCE;
+
+public:
+    StreamObject(ItrObject * Itr, const rocksdb::Slice & Start, const rocksdb::Slice * End,
+                 const ErlNifPid & Pid, unsigned ChunkSize);
+
+    ~StreamObject();
+
+    // close the iterator and release its snapshot, no more messages
+    void Close();
+
+    static void CreateStreamObjectType(ErlNifEnv * Env);
+
+    static StreamObject * CreateStreamObject(ItrObject * Itr, const rocksdb::Slice & Start,
+                                             const rocksdb::Slice * End, const ErlNifPid & Pid,
+                                             unsigned ChunkSize);
+
+    static StreamObject * RetrieveStreamObject(ErlNifEnv * Env, const ERL_NIF_TERM & StreamTerm);
+
+    static void StreamObjectResourceCleanup(ErlNifEnv *Env, void * Arg);
+
+private:
+    StreamObject();
+    StreamObject(const StreamObject &);            // no copy
+    StreamObject & operator=(const StreamObject &); // no assignment
+};  // class StreamObject
+
 } // namespace erocksdb
 
 
@@ -326,6 +326,57 @@ bool erocksdb_thread_pool::notify_caller(erocksdb::WorkTask& work_item)
     return(ret_flag);
 }
 
+/**
+ * Move queued writes that can share Leader's commit onto its
+ *  follower list.  Scanning stops at the first queued write to the
+ *  same database that cannot join, so writes to one database are
+ *  never committed ahead of an earlier queued write to it.  Only the
+ *  first WRITE_GROUP_MAX_SCAN entries are inspected since submit()
+ *  waits on the queue lock meanwhile.
+ */
+void erocksdb_thread_pool::CollectWriteGroup(erocksdb::WriteTask & Leader)
+{
+    // test non-blocking size for hint (much faster)
+    if (0!=work_queue_atomic)
+    {
+        size_t group_bytes, scanned;
+        work_queue_t::iterator it;
+
+        group_bytes=Leader.BatchSize();
+        scanned=0;
+
+        lock();
+        for (it=work_queue.begin();
+             work_queue.end()!=it && group_bytes<WRITE_GROUP_MAX_BYTES && scanned<WRITE_GROUP_MAX_SCAN;
+             ++scanned)
+        {
+            erocksdb::WriteTask * write_task=(*it)->is_write_task()
+                ? static_cast<erocksdb::WriteTask *>(*it) : NULL;
+
+            if (NULL!=write_task && Leader.CanGroupWith(*write_task))
+            {
+                group_bytes+=write_task->BatchSize();
+                Leader.AddFollower(write_task);
+                it=work_queue.erase(it);
+                erocksdb::dec_and_fetch(&work_queue_atomic);
+            }   // if
+            else if (NULL!=write_task && write_task->SameDb(Leader))
+            {
+                break;
+            }   // else if
+            else
+            {
+                ++it;
+            }   // else
+        }   // for
+        unlock();
+    }   // if
+
+    return;
+
+}   // CollectWriteGroup
+
+
 /**
  * Worker threads:  worker threads have 3 states:
  *  A. doing nothing, available to be claimed: m_Available=1
@@ -367,7 +418,36 @@ void *erocksdb_write_thread_worker(void *args)
         //  then loop to test queue again
         if (NULL!=submission)
         {
+            erocksdb::WriteTask * write_task=submission->is_write_task()
+                ? static_cast<erocksdb::WriteTask *>(submission) : NULL;
+
+            // pull compatible queued writes into one group commit
+            if (NULL!=write_task)
+                h.CollectWriteGroup(*write_task);
+
             erocksdb_thread_pool::notify_caller(*submission);
+
+            // followers were written by the leader, reply to their callers
+            if (NULL!=write_task)
+            {
+                std::vector<erocksdb::WriteTask *>::iterator it;
+
+                for (it=write_task->GetFollowers().begin(); write_task->GetFollowers().end()!=it; ++it)
+                {
+                    erocksdb_thread_pool::notify_caller(**it);
+                    (*it)->RefDec();
+                }   // for
+                write_task->GetFollowers().clear();
+            }   // if
+
+            // a parked task this one unblocked, e.g. the next put_if of a key stripe
+            erocksdb::WorkTask * handoff=submission->handoff();
+            if (NULL!=handoff)
+            {
+                h.submit(handoff);
+                handoff->RefDec();
+            }   // if
+
             if (submission->resubmit())
             {
                 submission->recycle();
@@ -37,10 +37,13 @@ namespace erocksdb {
 
 // constant
 const size_t N_THREADS_MAX = 32767;
+const size_t WRITE_GROUP_MAX_BYTES = 1 << 20;  //!< batch data merged into one group commit
+const size_t WRITE_GROUP_MAX_SCAN = 32;        //!< queue entries a leader inspects for followers
 
 // forward declare
 struct ThreadData;
 class WorkTask;
+class WriteTask;
 
 
 class erocksdb_thread_pool
@@ -90,6 +93,8 @@ private:
     bool grow_thread_pool(const size_t nthreads);
     bool drain_thread_pool();
 
+    void CollectWriteGroup(erocksdb::WriteTask & Leader);
+
     static bool notify_caller(erocksdb::WorkTask& work_item);
 
 };  // class erocksdb_thread_pool
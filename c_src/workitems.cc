@@ -27,8 +27,13 @@
     #include "workitems.h"
 #endif
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
 #include "rocksdb/cache.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/table_properties.h"
 
 // error_tuple duplicated in workitems.cc and erocksdb.cc ... how to fix?
 static ERL_NIF_TERM error_tuple(ErlNifEnv* env, ERL_NIF_TERM error, rocksdb::Status& status)
@@ -58,7 +63,8 @@ namespace erocksdb {
 
 
 WorkTask::WorkTask(ErlNifEnv *caller_env, ERL_NIF_TERM& caller_ref)
-    : terms_set(false), resubmit_work(false)
+    : terms_set(false), resubmit_work(false), handoff_work(NULL),
+      write_task(false)
 {
     if (NULL!=caller_env)
     {
@@ -79,7 +85,8 @@ WorkTask::WorkTask(ErlNifEnv *caller_env, ERL_NIF_TERM& caller_ref)
 
 
 WorkTask::WorkTask(ErlNifEnv *caller_env, ERL_NIF_TERM& caller_ref, DbObject * DbPtr)
-    : m_DbPtr(DbPtr), terms_set(false), resubmit_work(false)
+    : m_DbPtr(DbPtr), terms_set(false), resubmit_work(false), handoff_work(NULL),
+      write_task(false)
 {
     if (NULL!=caller_env)
     {
@@ -142,9 +149,10 @@ OpenTask::OpenTask(
     ErlNifEnv* caller_env,
     ERL_NIF_TERM& _caller_ref,
     const std::string& db_name_,
-    rocksdb::Options *Options_)
+    rocksdb::Options *Options_,
+    const DbObjectOptions & ObjectOptions_)
     : WorkTask(caller_env, _caller_ref),
-    db_name(db_name_), options(Options_)
+    db_name(db_name_), options(Options_), object_options(ObjectOptions_)
 {
 }   // OpenTask::OpenTask
 
@@ -160,7 +168,7 @@ OpenTask::operator()()
     if(!status.ok())
         return error_tuple(local_env(), ATOM_ERROR_DB_OPEN, status);
 
-    db_ptr=DbObject::CreateDbObject(db, options);
+    db_ptr=DbObject::CreateDbObject(db, options, object_options);
 
     // create a resource reference to send erlang
     ERL_NIF_TERM result = enif_make_resource(local_env(), db_ptr);
@@ -174,6 +182,728 @@ OpenTask::operator()()
 
 
 
+/**
+ * WriteTask functions
+ */
+
+/**
+ * Replays the operations of one batch into another
+ */
+class WriteBatchAppender : public rocksdb::WriteBatch::Handler
+{
+    rocksdb::WriteBatch & m_Target;
+
+public:
+    WriteBatchAppender(rocksdb::WriteBatch & Target) : m_Target(Target) {};
+
+    virtual void Put(const rocksdb::Slice& key, const rocksdb::Slice& value)
+        {m_Target.Put(key, value);};
+
+    virtual void Merge(const rocksdb::Slice& key, const rocksdb::Slice& value)
+        {m_Target.Merge(key, value);};
+
+    virtual void Delete(const rocksdb::Slice& key)
+        {m_Target.Delete(key);};
+
+    virtual void LogData(const rocksdb::Slice& blob)
+        {m_Target.PutLogData(blob);};
+
+};  // class WriteBatchAppender
+
+
+work_result
+WriteTask::operator()()
+{
+    rocksdb::Status status;
+
+    // a leader already committed this batch
+    if (m_GroupDone)
+    {
+        status=m_GroupStatus;
+    }   // if
+
+    // combine followers into one batch: one WAL append and
+    //  (if sync) one fsync for the whole group
+    else if (!m_Followers.empty())
+    {
+        size_t total;
+        std::vector<WriteTask *>::iterator it;
+
+        total=batch->GetDataSize();
+        for (it=m_Followers.begin(); m_Followers.end()!=it; ++it)
+            total+=(*it)->batch->GetDataSize();
+
+        rocksdb::WriteBatch group(total);
+        WriteBatchAppender appender(group);
+
+        status=batch->Iterate(&appender);
+        for (it=m_Followers.begin(); m_Followers.end()!=it && status.ok(); ++it)
+            status=(*it)->batch->Iterate(&appender);
+
+        if (status.ok())
+            status=m_DbPtr->m_Db->Write(*options, &group);
+
+        for (it=m_Followers.begin(); m_Followers.end()!=it; ++it)
+        {
+            (*it)->m_GroupStatus=status;
+            (*it)->m_GroupDone=true;
+        }   // for
+    }   // else if
+
+    else
+    {
+        status=m_DbPtr->m_Db->Write(*options, batch);
+    }   // else
+
+    // caller is not waiting, no message
+    if (0!=m_NoReplyTicket)
+    {
+        m_DbPtr->CompleteNoReplyWrite(m_NoReplyTicket, status.ok());
+        return(work_result());
+    }   // if
+
+    return (status.ok() ? work_result(ATOM_OK) : work_result(local_env(), ATOM_ERROR_DB_WRITE, status));
+
+}   // WriteTask::operator()
+
+
+
+/**
+ * DeleteRangeTask functions
+ */
+
+work_result
+DeleteRangeTask::operator()()
+{
+    rocksdb::Status status;
+    rocksdb::WriteBatch batch;
+
+    resubmit_work=false;
+
+    // a close waits on this task, give up instead of holding it
+    if (m_DbPtr->m_CloseRequested)
+        return work_result(local_env(), ATOM_ERROR, ATOM_ITERATOR_CLOSED);
+
+    if (NULL==m_Iterator)
+    {
+        rocksdb::ReadOptions read_options;
+
+        // a one time scan, keep it out of the block cache
+        read_options.fill_cache=false;
+        read_options.iterate_upper_bound=&m_UpperSlice;
+
+        m_Iterator=m_DbPtr->m_Db->NewIterator(read_options);
+        m_Iterator->Seek(m_Start);
+    }   // if
+
+    // rocksdb stops at the upper bound
+    for (; m_Iterator->Valid() && (size_t)batch.Count()<DELETE_RANGE_BATCH_KEYS; m_Iterator->Next())
+        batch.Delete(m_Iterator->key());
+
+    if (0!=batch.Count())
+    {
+        status=m_DbPtr->m_Db->Write(*options, &batch);
+        if (status.ok())
+            m_Deleted+=batch.Count();
+    }   // if
+
+    if (status.ok() && m_Iterator->Valid())
+    {
+        // no reply yet, continue behind other queued work
+        resubmit_work=true;
+        return work_result();
+    }   // if
+
+    if (status.ok())
+        status=m_Iterator->status();
+
+    if (status.ok() && m_Compact)
+    {
+        rocksdb::Slice start_slice(m_Start);
+        status=m_DbPtr->m_Db->CompactRange(&start_slice, &m_UpperSlice);
+    }   // if
+
+    if (!status.ok())
+        return work_result(local_env(), ATOM_ERROR_DB_WRITE, status);
+
+    return work_result(local_env(), ATOM_OK, enif_make_uint64(local_env(), m_Deleted));
+
+}   // DeleteRangeTask::operator()
+
+
+
+/**
+ * FinishBulkLoadTask functions
+ */
+
+work_result
+FinishBulkLoadTask::operator()()
+{
+    rocksdb::Status status;
+    bool was_bulk_load;
+
+    // writes from here on use the WAL again, the flush covers those before
+    was_bulk_load=m_DbPtr->m_ObjectOptions.m_BulkLoad.exchange(false);
+
+    status=m_DbPtr->m_Db->Flush(rocksdb::FlushOptions());
+
+    if (!status.ok())
+    {
+        // WAL-less data is still only in the memtable, stay in bulk mode
+        //  so a retry of finish_bulk_load flushes it
+        if (was_bulk_load)
+            m_DbPtr->m_ObjectOptions.m_BulkLoad=true;
+
+        return work_result(local_env(), ATOM_ERROR_DB_BULK_LOAD, status);
+    }   // if
+
+    // everything bulk_load changed is dynamic, the values are those
+    //  of open.  Restored before the compaction so a failed compaction
+    //  still leaves normal triggers behind
+    if (!m_DbPtr->m_ObjectOptions.m_BulkLoadRestore.empty())
+        status=m_DbPtr->m_Db->SetOptions(m_DbPtr->m_ObjectOptions.m_BulkLoadRestore);
+
+    if (status.ok())
+        status=m_DbPtr->m_Db->CompactRange(NULL, NULL);
+
+    if (!status.ok())
+        return work_result(local_env(), ATOM_ERROR_DB_BULK_LOAD, status);
+
+    return work_result(ATOM_OK);
+
+}   // FinishBulkLoadTask::operator()
+
+
+
+/**
+ * PutIfTask functions
+ */
+
+work_result
+PutIfTask::operator()()
+{
+    size_t stripe(m_DbPtr->KeyStripe(m_Key));
+    work_result result;
+
+    // another put_if owns the stripe, park until it hands it over.  Set
+    //  before parking, the next run may start before this one returns
+    if (!m_OwnsStripe)
+    {
+        m_OwnsStripe=true;
+        if (!m_DbPtr->KeyLockAcquire(stripe, this))
+            return work_result();
+    }   // if
+
+    result=DoPutIf();
+
+    handoff_work=m_DbPtr->KeyLockRelease(stripe);
+
+    return(result);
+
+}   // PutIfTask::operator()
+
+
+work_result
+PutIfTask::DoPutIf()
+{
+    rocksdb::Status status;
+    std::string current;
+
+    status=m_DbPtr->m_Db->Get(rocksdb::ReadOptions(), m_Key, &current);
+
+    if (status.IsNotFound())
+    {
+        if (!m_ExpectNotFound)
+            return work_result(local_env(), ATOM_CONFLICT, ATOM_NOT_FOUND);
+    }   // if
+    else if (status.ok())
+    {
+        if (m_ExpectNotFound || current!=m_Expected)
+        {
+            ERL_NIF_TERM value_bin;
+
+            memcpy(enif_make_new_binary(local_env(), current.size(), &value_bin),
+                   current.data(), current.size());
+            return work_result(local_env(), ATOM_CONFLICT, value_bin);
+        }   // if
+    }   // else if
+    else
+    {
+        return work_result(local_env(), ATOM_ERROR_DB_GET, status);
+    }   // else
+
+    status=m_DbPtr->m_Db->Put(*options, m_Key, m_Value);
+
+    if (!status.ok())
+        return work_result(local_env(), ATOM_ERROR_DB_PUT, status);
+
+    return work_result(ATOM_OK);
+
+}   // PutIfTask::DoPutIf
+
+
+
+/**
+ * Reply is {ok, [{Start, End}]}, contiguous shards in key order.  The
+ *  last End is undefined for an open range.  Fewer shards than asked
+ *  come back when the files offer too few cut points, e.g. while all
+ *  data is still in the memtable.
+ */
+work_result
+SplitRangeTask::operator()()
+{
+    std::vector<rocksdb::LiveFileMetaData> files;
+    std::vector<rocksdb::LiveFileMetaData>::iterator file;
+    std::vector<std::string> candidates, cuts;
+    std::vector<ERL_NIF_TERM> shards;
+    std::string limit;
+    size_t loop;
+
+    m_DbPtr->m_Db->GetLiveFilesMetaData(&files);
+
+    for (file=files.begin(); files.end()!=file; ++file)
+    {
+        const std::string * keys[2] = {&file->smallestkey, &file->largestkey};
+
+        for (loop=0; loop<2; ++loop)
+        {
+            if (m_Start<*keys[loop] && (!m_HasEnd || *keys[loop]<m_End))
+                candidates.push_back(*keys[loop]);
+        }   // for
+
+        if (limit<file->largestkey)
+            limit=file->largestkey;
+    }   // for
+
+    // open range is sized up to just past the largest key
+    if (m_HasEnd)
+        limit=m_End;
+    else
+        limit.push_back('\0');
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    if (1<m_Shards && !candidates.empty())
+    {
+        std::vector<rocksdb::Range> ranges;
+        std::vector<uint64_t> sizes;
+        uint64_t total(0), running(0);
+
+        // segment i ends at candidates[i], the last one at limit
+        ranges.push_back(rocksdb::Range(m_Start, candidates[0]));
+        for (loop=1; loop<candidates.size(); ++loop)
+            ranges.push_back(rocksdb::Range(candidates[loop-1], candidates[loop]));
+        ranges.push_back(rocksdb::Range(candidates.back(), limit));
+
+        sizes.resize(ranges.size());
+        m_DbPtr->m_Db->GetApproximateSizes(&ranges[0], (int)ranges.size(), &sizes[0]);
+
+        for (loop=0; loop<sizes.size(); ++loop)
+            total+=sizes[loop];
+
+        // cut where the running size passes the next multiple of total/shards
+        for (loop=0; 0<total && loop<candidates.size() && cuts.size()+1<m_Shards; ++loop)
+        {
+            running+=sizes[loop];
+            if (total*(cuts.size()+1)<=running*m_Shards)
+                cuts.push_back(candidates[loop]);
+        }   // for
+    }   // if
+
+    for (loop=0; loop<=cuts.size(); ++loop)
+    {
+        ERL_NIF_TERM start, end;
+
+        start=slice_to_binary(local_env(), 0==loop ? m_Start : cuts[loop-1]);
+
+        if (loop<cuts.size())
+            end=slice_to_binary(local_env(), cuts[loop]);
+        else if (m_HasEnd)
+            end=slice_to_binary(local_env(), m_End);
+        else
+            end=ATOM_UNDEFINED;
+
+        shards.push_back(enif_make_tuple2(local_env(), start, end));
+    }   // for
+
+    return work_result(local_env(), ATOM_OK,
+                       enif_make_list_from_array(local_env(), &shards[0], shards.size()));
+
+}   // SplitRangeTask::operator()
+
+
+bool
+StreamTask::Send(
+    ErlNifEnv * MsgEnv,
+    ERL_NIF_TERM Payload)
+{
+    ERL_NIF_TERM msg;
+
+    // {erocksdb_stream, Stream, Payload}, enif_send clears MsgEnv
+    msg=enif_make_tuple3(MsgEnv, ATOM_STREAM, enif_make_resource(MsgEnv, m_Stream), Payload);
+
+    return(0!=enif_send(NULL, &m_Stream->m_Pid, MsgEnv, msg));
+
+}   // StreamTask::Send
+
+
+work_result
+StreamTask::operator()()
+{
+    ErlNifEnv * msg_env;
+    std::vector<ERL_NIF_TERM> entries;
+    size_t bytes(0);
+    bool done(false), sent(true), closing;
+
+    resubmit_work=false;
+    msg_env=enif_alloc_env();
+
+    // stream_close while queued, nothing more to send
+    {
+        MutexLock lock(m_Stream->m_StreamMutex);
+        done=m_Stream->m_Done;
+    }
+
+    if (!done && (NULL==m_ItrWrap.get() || m_ItrWrap->m_DbPtr->m_CloseRequested
+                  || m_Stream->m_Itr->m_CloseRequested))
+    {
+        sent=Send(msg_env, enif_make_tuple2(msg_env, ATOM_ERROR, ATOM_ITERATOR_CLOSED));
+        done=true;
+    }   // if
+    else if (!done)
+    {
+        MutexLock lock(m_ItrWrap->m_IterMutex);
+        rocksdb::Iterator * itr(m_ItrWrap->get());
+        rocksdb::Slice end_slice(m_Stream->m_End);
+
+        // only one StreamTask runs per stream, m_Running guards the
+        //  iterator and the stream position
+        if (!m_Stream->m_Positioned)
+        {
+            m_ItrWrap->Seek(rocksdb::Slice(m_Stream->m_Start));
+            m_Stream->m_Positioned=true;
+        }   // if
+
+        // the iterator stays on the first entry not yet sent, so the
+        //  last chunk and done go out in the same run
+        while (entries.size()<m_Stream->m_ChunkSize && bytes<MOVE_BATCH_BYTES
+               && m_ItrWrap->Valid()
+               && (!m_Stream->m_HasEnd || 0>itr->key().compare(end_slice)))
+        {
+            if (m_ItrWrap->m_KeysOnly)
+            {
+                entries.push_back(slice_to_binary(msg_env, itr->key()));
+                bytes+=itr->key().size();
+            }   // if
+            else
+            {
+                entries.push_back(enif_make_tuple2(msg_env,
+                                                   slice_to_binary(msg_env, itr->key()),
+                                                   slice_to_binary(msg_env, itr->value())));
+                bytes+=itr->key().size() + itr->value().size();
+            }   // else
+
+            itr->Next();
+        }   // while
+
+        done=!m_ItrWrap->Valid()
+            || (m_Stream->m_HasEnd && 0<=itr->key().compare(end_slice));
+
+        if (!entries.empty())
+            sent=Send(msg_env, enif_make_tuple2(msg_env, ATOM_DATA,
+                                                enif_make_list_from_array(msg_env, &entries[0],
+                                                                          entries.size())));
+
+        if (sent && done)
+        {
+            rocksdb::Status status(itr->status());
+
+            if (status.ok())
+                sent=Send(msg_env, ATOM_DONE);
+            else
+                sent=Send(msg_env, error_tuple(msg_env, ATOM_ERROR_DB_GET, status));
+        }   // if
+    }   // else if
+
+    enif_free_env(msg_env);
+
+    // a dead consumer ends the stream as well
+    {
+        MutexLock lock(m_Stream->m_StreamMutex);
+
+        if (done || !sent)
+            m_Stream->m_Done=true;
+        else if (!entries.empty())
+            --m_Stream->m_Credits;
+
+        resubmit_work=!m_Stream->m_Done && 0<m_Stream->m_Credits;
+        m_Stream->m_Running=resubmit_work;
+        closing=m_Stream->m_Done;
+    }
+
+    if (closing)
+        m_Stream->Close();
+
+    return work_result();
+
+}   // StreamTask::operator()
+
+
+work_result
+CountRangeTask::operator()()
+{
+    resubmit_work=false;
+
+    return(m_Exact ? CountExact() : Estimate());
+
+}   // CountRangeTask::operator()
+
+
+work_result
+CountRangeTask::CountExact()
+{
+    uint64_t loop;
+
+    // a close waits on this task, give up instead of holding it
+    if (m_DbPtr->m_CloseRequested)
+        return work_result(local_env(), ATOM_ERROR, ATOM_ITERATOR_CLOSED);
+
+    if (NULL==m_Iterator)
+    {
+        rocksdb::ReadOptions options;
+
+        // one pass over cold data, keep it out of the block cache
+        options.fill_cache=false;
+        if (m_HasEnd)
+            options.iterate_upper_bound=&m_UpperSlice;
+
+        m_Iterator=m_DbPtr->m_Db->NewIterator(options);
+        m_Iterator->Seek(m_Start);
+    }   // if
+
+    // rocksdb stops at the upper bound, keys are never copied
+    for (loop=0; loop<COUNT_KEYS_PER_RUN && m_Iterator->Valid(); ++loop)
+    {
+        ++m_Count;
+        m_Iterator->Next();
+    }   // for
+
+    if (m_Iterator->Valid())
+    {
+        // no reply yet, continue behind other queued work
+        resubmit_work=true;
+        return work_result();
+    }   // if
+
+    rocksdb::Status status(m_Iterator->status());
+
+    if (!status.ok())
+        return work_result(local_env(), ATOM_ERROR_DB_GET, status);
+
+    return work_result(local_env(), ATOM_OK, enif_make_uint64(local_env(), m_Count));
+
+}   // CountRangeTask::CountExact
+
+
+work_result
+CountRangeTask::Estimate()
+{
+    std::vector<rocksdb::LiveFileMetaData> files;
+    std::vector<rocksdb::LiveFileMetaData>::iterator file;
+    rocksdb::TablePropertiesCollection props;
+    rocksdb::TablePropertiesCollection::iterator prop;
+    rocksdb::Status status;
+    std::string limit;
+    uint64_t range_bytes(0), covered_bytes(0), partial_bytes(0), partial_entries(0);
+
+    m_DbPtr->m_Db->GetLiveFilesMetaData(&files);
+    status=m_DbPtr->m_Db->GetPropertiesOfAllTables(&props);
+
+    if (!status.ok())
+        return work_result(local_env(), ATOM_ERROR_DB_GET, status);
+
+    for (file=files.begin(); files.end()!=file; ++file)
+    {
+        if (limit<file->largestkey)
+            limit=file->largestkey;
+
+        // properties are keyed by full path, metadata names start with '/'
+        prop=props.find(file->db_path + file->name);
+
+        if (props.end()==prop
+            || file->largestkey<m_Start || (m_HasEnd && m_End<=file->smallestkey))
+            continue;
+
+        // whole files inside the range count exactly, the rest sets
+        //  the entries per byte of the range's partial files
+        if (m_Start<=file->smallestkey && (!m_HasEnd || file->largestkey<m_End))
+        {
+            m_Count+=prop->second->num_entries;
+            covered_bytes+=file->size;
+        }   // if
+        else
+        {
+            partial_entries+=prop->second->num_entries;
+            partial_bytes+=file->size;
+        }   // else
+    }   // for
+
+    // open range is sized up to just past the largest key
+    if (m_HasEnd)
+        limit=m_End;
+    else
+        limit.push_back('\0');
+
+    if (0<partial_bytes && m_Start<limit)
+    {
+        rocksdb::Range range(m_Start, limit);
+
+        m_DbPtr->m_Db->GetApproximateSizes(&range, 1, &range_bytes);
+
+        if (covered_bytes<range_bytes)
+            m_Count+=(uint64_t)((double)(range_bytes-covered_bytes)
+                                * partial_entries / partial_bytes);
+    }   // if
+
+    return work_result(local_env(), ATOM_OK, enif_make_uint64(local_env(), m_Count));
+
+}   // CountRangeTask::Estimate
+
+
+
+/**
+ * GetTask functions
+ */
+
+void
+GetTask::AddWaiter(
+    ErlNifEnv * CallerEnv,
+    const ERL_NIF_TERM & CallerRef)
+{
+    ErlNifPid pid;
+
+    if (NULL==m_WaiterEnv)
+        m_WaiterEnv=enif_alloc_env();
+
+    enif_self(CallerEnv, &pid);
+    m_Waiters.push_back(std::make_pair(pid, enif_make_copy(m_WaiterEnv, CallerRef)));
+
+    return;
+
+}   // GetTask::AddWaiter
+
+
+work_result
+GetTask::operator()()
+{
+    work_result result;
+
+    // leave the in-flight table before reading so that any get
+    //  arriving from now on starts its own lookup (and sees writes
+    //  its caller completed before asking)
+    if (m_Coalesced)
+    {
+        MutexLock lock(m_DbPtr->m_InFlightMutex);
+        std::map<std::string, GetTask *>::iterator it;
+
+        it=m_DbPtr->m_InFlightGets.find(m_InFlightKey);
+        if (m_DbPtr->m_InFlightGets.end()!=it && this==it->second)
+            m_DbPtr->m_InFlightGets.erase(it);
+    }   // if
+
+    result=DoGet();
+
+    // m_Waiters is frozen now, no lock needed
+    if (!m_Waiters.empty())
+    {
+        size_t failed;
+
+        // erocksdb.coalesced-gets counts answered gets only
+        failed=NotifyWaiters(result.result());
+        if (0!=failed)
+        {
+            MutexLock lock(m_DbPtr->m_InFlightMutex);
+            m_DbPtr->m_CoalescedGets-=failed;
+        }   // if
+    }   // if
+
+    return(result);
+
+}   // GetTask::operator()
+
+
+work_result
+GetTask::DoGet()
+{
+    ERL_NIF_TERM value_bin;
+    std::string value;
+    rocksdb::Slice key_slice(m_Key);
+
+    if (m_ZeroCopy)
+    {
+        // rocksdb writes into buffer owned by resource, erlang
+        //  binary then points at that buffer
+        ValueObject * value_ptr=ValueObject::CreateValueObject();
+
+        rocksdb::Status status = m_DbPtr->m_Db->Get(*options, key_slice, &value_ptr->m_Value);
+
+        if(!status.ok())
+        {
+            // release reference created during CreateValueObject()
+            enif_release_resource(value_ptr);
+            return work_result(ATOM_NOT_FOUND);
+        }   // if
+
+        return work_result(local_env(), ATOM_OK, value_ptr->MakeBinary(local_env()));
+    }   // if
+
+    rocksdb::Status status = m_DbPtr->m_Db->Get(*options, key_slice, &value);
+
+    if(!status.ok())
+        return work_result(ATOM_NOT_FOUND);
+
+    unsigned char* v = enif_make_new_binary(local_env(), value.size(), &value_bin);
+    memcpy(v, value.c_str(), value.size());
+
+    return work_result(local_env(), ATOM_OK, value_bin);
+
+}   // GetTask::DoGet
+
+
+size_t
+GetTask::NotifyWaiters(
+    const ERL_NIF_TERM & Result)
+{
+    std::vector<std::pair<ErlNifPid, ERL_NIF_TERM> >::iterator it;
+    size_t failed;
+
+    failed=0;
+
+    // each message needs its own env since enif_send() consumes it,
+    //  binaries are reference counted so the copy is cheap
+    for (it=m_Waiters.begin(); m_Waiters.end()!=it; ++it)
+    {
+        ErlNifEnv * msg_env=enif_alloc_env();
+        ERL_NIF_TERM msg=enif_make_tuple2(msg_env,
+                                          enif_make_copy(msg_env, it->second),
+                                          enif_make_copy(msg_env, Result));
+        int sent;
+
+        // a failed send means the waiter died, nobody is left to answer
+        sent=enif_send(NULL, &it->first, msg_env, msg);
+        enif_free_env(msg_env);
+
+        if (!sent)
+            ++failed;
+    }   // for
+
+    return(failed);
+
+}   // GetTask::NotifyWaiters
+
+
+
 /**
  * MoveTask functions
  */
@@ -186,22 +916,51 @@ MoveTask::operator()()
     if(NULL == itr)
         return work_result(local_env(), ATOM_ERROR, ATOM_ITERATOR_CLOSED);
 
+    // a prefetch can still be queued or running when erlang
+    //  switches to another action
+    MutexLock lock(m_ItrWrap->m_IterMutex);
+
+    if (PREFETCH==action)
+        return(Prefetch(itr));
+
+    // async_iterator_move found a parked prefetch but not the lock:
+    //  send the parked entry and keep prefetching, as it does inline
+    if (PARKED==action)
+    {
+        m_ItrWrap->m_Ahead=false;
+        m_ItrWrap->m_HandoffAtomic=0;
+
+        // the inline path always queues the next prefetch, even at the
+        //  end, a later next call waits on it
+        action=PREFETCH;
+        prepare_recycle();
+
+        return(EntryResult(itr));
+    }   // if
+
+    m_ItrWrap->DropPrefetch();
+
+    if (0!=batch_count && (NEXT==action || PREV==action))
+        return(MoveBatch(itr));
+
+    if (SCAN==action)
+        return(ScanChunk(itr));
+
     switch(action)
     {
-        case FIRST: itr->SeekToFirst(); break;
+        case FIRST: m_ItrWrap->SeekToFirst(); break;
 
-        case LAST:  itr->SeekToLast();  break;
+        case LAST:  m_ItrWrap->SeekToLast(); break;
 
-        case PREFETCH:
-        case NEXT:  if(itr->Valid()) itr->Next(); break;
+        case NEXT:  if(m_ItrWrap->Valid()) itr->Next(); break;
 
-        case PREV:  if(itr->Valid()) itr->Prev(); break;
+        case PREV:  if(m_ItrWrap->Valid()) itr->Prev(); break;
 
         case SEEK:
         {
             rocksdb::Slice key_slice(seek_target);
 
-            itr->Seek(key_slice);
+            m_ItrWrap->Seek(key_slice);
             break;
         }   // case
 
@@ -214,41 +973,209 @@ MoveTask::operator()()
 
     }   // switch
 
+    return(EntryResult(itr));
+
+}   // MoveTask::operator()
+
+
+/**
+ * Adaptive prefetch, see async_iterator_move.  If erlang is already
+ *  waiting (handoff is 1) the entry goes out by message and this task
+ *  is resubmitted for the entry after.  Otherwise the task parks on the
+ *  entry and the next NIF call replies with it inline.
+ */
+work_result
+MoveTask::Prefetch(
+    rocksdb::Iterator * itr)
+{
+    bool moved;
+
+    // erlang left prefetch mode after this task was queued
+    if (prefetch_generation != m_ItrWrap->m_PrefetchGeneration)
+        return(work_result());
+
+    moved=m_ItrWrap->Valid();
+    if (moved)
+        itr->Next();
 
     // who got back first, us or the erlang loop
     if (compare_and_swap(&m_ItrWrap->m_HandoffAtomic, 0, 1))
     {
-        // this is prefetch of next iteration.  It returned faster than actual
-        //  request to retrieve it.  Stop and wait for erlang to catch up.
+        // faster than erlang.  Stop and wait for erlang to catch up
         //  (even if this result is an Invalid() )
+        m_ItrWrap->m_Ahead=moved;
+        return(work_result());
     }   // if
-    else
+
+    // setup next race for the response
+    m_ItrWrap->m_HandoffAtomic=0;
+
+    if (m_ItrWrap->Valid())
+        prepare_recycle();
+
+    return(EntryResult(itr));
+
+}   // MoveTask::Prefetch
+
+
+work_result
+MoveTask::EntryResult(
+    rocksdb::Iterator * itr)
+{
+    if(m_ItrWrap->Valid())
     {
-        // setup next race for the response
-        m_ItrWrap->m_HandoffAtomic=0;
+        if(m_ItrWrap->m_KeysOnly)
+            return work_result(local_env(), ATOM_OK, slice_to_binary(local_env(), itr->key()));
+
+        return work_result(local_env(), ATOM_OK,
+                           slice_to_binary(local_env(), itr->key()),
+                           slice_to_binary(local_env(), itr->value()));
+    }   // if
+
+    return work_result(local_env(), ATOM_ERROR, ATOM_INVALID_ITERATOR);
+
+}   // MoveTask::EntryResult
+
+
+/**
+ * {next, N} and {prev, N}:  up to N steps in one task, entries
+ *  returned as one list in iteration order.  Stops early once
+ *  MOVE_BATCH_BYTES of keys and values are collected.
+ */
+work_result
+MoveTask::MoveBatch(
+    rocksdb::Iterator * itr)
+{
+    std::vector<ERL_NIF_TERM> entries;
+    size_t bytes(0);
+
+    entries.reserve(batch_count);
+
+    while (entries.size()<batch_count && bytes<MOVE_BATCH_BYTES && m_ItrWrap->Valid())
+    {
+        if (NEXT==action)
+            itr->Next();
+        else
+            itr->Prev();
 
-        if(itr->Valid())
+        if (!m_ItrWrap->Valid())
+            break;
+
+        if (m_ItrWrap->m_KeysOnly)
+        {
+            entries.push_back(slice_to_binary(local_env(), itr->key()));
+            bytes+=itr->key().size();
+        }   // if
+        else
         {
-            if (PREFETCH==action)
-                prepare_recycle();
+            entries.push_back(enif_make_tuple2(local_env(),
+                                               slice_to_binary(local_env(), itr->key()),
+                                               slice_to_binary(local_env(), itr->value())));
+            bytes+=itr->key().size() + itr->value().size();
+        }   // else
+    }   // while
+
+    if (entries.empty())
+        return work_result(local_env(), ATOM_ERROR, ATOM_INVALID_ITERATOR);
+
+    return work_result(local_env(), ATOM_OK,
+                       enif_make_list_from_array(local_env(), &entries[0], entries.size()));
+
+}   // MoveTask::MoveBatch
+
+
+/**
+ * From is first, next or a start key, End is undefined or the
+ *  exclusive end key.  Keys are compared bytewise, the comparator
+ *  every erocksdb database uses.
+ */
+bool
+MoveTask::SetScanRange(
+    ErlNifEnv * Env,
+    ERL_NIF_TERM From,
+    ERL_NIF_TERM End)
+{
+    ErlNifBinary key;
+
+    if (ATOM_FIRST==From)
+        scan_from=FIRST;
+    else if (ATOM_NEXT==From)
+        scan_from=NEXT;
+    else if (enif_inspect_binary(Env, From, &key))
+    {
+        scan_from=SEEK;
+        seek_target.assign((const char *)key.data, key.size);
+    }   // else if
+    else
+        return(false);
+
+    if (enif_inspect_binary(Env, End, &key))
+    {
+        has_scan_end=true;
+        scan_end.assign((const char *)key.data, key.size);
+    }   // if
+    else if (ATOM_UNDEFINED!=End)
+        return(false);
+
+    return(true);
+
+}   // MoveTask::SetScanRange
+
+
+/**
+ * One chunk of a range fold.  The iterator is left on the last entry
+ *  returned so the following chunk starts with NEXT.  Reply is
+ *  {done, Entries} once the range is exhausted, {ok, Entries} otherwise.
+ */
+work_result
+MoveTask::ScanChunk(
+    rocksdb::Iterator * itr)
+{
+    std::vector<ERL_NIF_TERM> entries;
+    size_t bytes(0);
+    bool done(false);
+    rocksdb::Slice end_slice(scan_end);
+
+    switch(scan_from)
+    {
+        case FIRST: m_ItrWrap->SeekToFirst(); break;
+        case SEEK:  m_ItrWrap->Seek(rocksdb::Slice(seek_target)); break;
+        default:    if(m_ItrWrap->Valid()) itr->Next(); break;
+    }   // switch
 
-            // erlang is waiting, send message
-            if(m_ItrWrap->m_KeysOnly)
-                return work_result(local_env(), ATOM_OK, slice_to_binary(local_env(), itr->key()));
+    while (!done)
+    {
+        if (!m_ItrWrap->Valid() || (has_scan_end && 0<=itr->key().compare(end_slice)))
+        {
+            done=true;
+            break;
+        }   // if
 
-            return work_result(local_env(), ATOM_OK,
-                               slice_to_binary(local_env(), itr->key()),
-                               slice_to_binary(local_env(), itr->value()));
+        if (m_ItrWrap->m_KeysOnly)
+        {
+            entries.push_back(slice_to_binary(local_env(), itr->key()));
+            bytes+=itr->key().size();
         }   // if
         else
         {
-            return work_result(local_env(), ATOM_ERROR, ATOM_INVALID_ITERATOR);
+            entries.push_back(enif_make_tuple2(local_env(),
+                                               slice_to_binary(local_env(), itr->key()),
+                                               slice_to_binary(local_env(), itr->value())));
+            bytes+=itr->key().size() + itr->value().size();
         }   // else
 
-    }   // else
+        if (batch_count<=entries.size() || MOVE_BATCH_BYTES<=bytes)
+            break;
 
-    return(work_result());
-}
+        itr->Next();
+    }   // while
+
+    ERL_NIF_TERM list = entries.empty() ? enif_make_list(local_env(), 0)
+        : enif_make_list_from_array(local_env(), &entries[0], entries.size());
+
+    return work_result(local_env(), done ? ATOM_DONE : ATOM_OK, list);
+
+}   // MoveTask::ScanChunk
 
 
 ErlNifEnv *
@@ -259,7 +1186,7 @@ MoveTask::local_env()
 
     if (!terms_set)
     {
-        caller_ref_term = enif_make_copy(local_env_, m_ItrWrap->m_Snap->itr_ref);
+        caller_ref_term = enif_make_copy(local_env_, m_ItrWrap->itr_ref);
         caller_pid_term = enif_make_pid(local_env_, &local_pid);
         terms_set=true;
     }   // if
@@ -24,6 +24,8 @@
 #define INCL_WORKITEMS_H
 
 #include <stdint.h>
+#include <atomic>
+#include <vector>
 
 #include "rocksdb/db.h"
 #include "rocksdb/write_batch.h"
@@ -51,6 +53,18 @@ namespace erocksdb {
 /* Type returned from a work task: */
 typedef leofs::async_nif::work_result   work_result;
 
+// deletes per internal write of a DeleteRangeTask
+const size_t DELETE_RANGE_BATCH_KEYS = 1024;
+
+// key/value bytes per reply of a batched iterator_move
+const size_t MOVE_BATCH_BYTES = 1 << 20;
+
+// single next calls in a row before an iterator starts prefetching
+const uint32_t PREFETCH_AFTER_NEXTS = 3;
+
+// keys an exact count_range visits per run before resubmitting
+const uint64_t COUNT_KEYS_PER_RUN = 64 * 1024;
+
 
 
 /**
@@ -69,6 +83,8 @@ protected:
     bool           terms_set;
 
     bool resubmit_work;           //!< true if this work item is loaded for prefetch
+    std::atomic<WorkTask *> handoff_work; //!< parked task this one made runnable, holds a reference
+    bool write_task;              //!< true for WriteTask, lets the pool skip RTTI
 
     ErlNifPid local_pid;   // maintain for task lifetime (JFW)
 
@@ -89,6 +105,12 @@ protected:
     const ERL_NIF_TERM& caller_ref()       { local_env(); return caller_ref_term; }
     const ERL_NIF_TERM& pid()              { local_env(); return caller_pid_term; }
     bool resubmit() const {return(resubmit_work);}
+    bool is_write_task() const {return(write_task);}
+
+    // pool submits the returned task after this one, caller owns its reference.
+    //  A parked task may be run again before the pool is done with its
+    //  parking run, the exchange hands the pointer to only one of them
+    WorkTask * handoff() {return(handoff_work.exchange(NULL));}
 
     virtual work_result operator()()     = 0;
 
@@ -109,11 +131,13 @@ class OpenTask : public WorkTask
 protected:
     std::string         db_name;
     rocksdb::Options   *options;  // associated with db handle, we don't free it
+    DbObjectOptions     object_options;
 
 public:
     OpenTask(ErlNifEnv* caller_env, ERL_NIF_TERM& _caller_ref,
              const std::string& db_name_, 
-             rocksdb::Options *Options_);
+             rocksdb::Options *Options_,
+             const DbObjectOptions & ObjectOptions_);
 
     virtual ~OpenTask() {};
 
@@ -129,7 +153,9 @@ private:
 
 
 /**
- * Background object for async write
+ * Background object for async write.  A worker may merge queued
+ *  writes to the same database with compatible options into one
+ *  group commit (see erocksdb_thread_pool::CollectWriteGroup)
  */
 
 class WriteTask : public WorkTask
@@ -138,6 +164,11 @@ protected:
     rocksdb::WriteBatch*    batch;
     rocksdb::WriteOptions*  options;
 
+    std::vector<WriteTask *> m_Followers;  //!< writes committed with this one, each holds a reference
+    bool                    m_GroupDone;   //!< true if a leader already wrote this batch
+    rocksdb::Status         m_GroupStatus; //!< leader's status when m_GroupDone
+    uint64_t                m_NoReplyTicket; //!< non-zero: no reply, complete ticket in DbObject
+
 public:
 
     WriteTask(ErlNifEnv* _owner_env, ERL_NIF_TERM _caller_ref,
@@ -146,8 +177,16 @@ public:
                 rocksdb::WriteOptions* _options)
         : WorkTask(_owner_env, _caller_ref, _db_handle),
        batch(_batch),
-       options(_options)
-    {}
+       options(_options),
+       m_GroupDone(false),
+       m_NoReplyTicket(0)
+    {
+        write_task=true;
+
+        // data loaded in bulk mode is made durable by finish_bulk_load's flush
+        if (_db_handle->m_ObjectOptions.m_BulkLoad)
+            options->disableWAL=true;
+    }
 
     virtual ~WriteTask()
     {
@@ -155,18 +194,35 @@ public:
         delete options;
     }
 
-    virtual work_result operator()()
+    // true if Other may be committed within this write
+    bool CanGroupWith(WriteTask & Other)
     {
-        rocksdb::Status status = m_DbPtr->m_Db->Write(*options, batch);
-
-        return (status.ok() ? work_result(ATOM_OK) : work_result(local_env(), ATOM_ERROR_DB_WRITE, status));
+        return(SameDb(Other)
+               && options->sync==Other.options->sync
+               && options->disableWAL==Other.options->disableWAL
+               && options->timeout_hint_us==Other.options->timeout_hint_us);
     }
 
+    bool SameDb(WriteTask & Other) {return(m_DbPtr.get()==Other.m_DbPtr.get());}
+
+    size_t BatchSize() const {return(batch->GetDataSize());}
+
+    // takes over the caller's reference to Follower
+    void AddFollower(WriteTask * Follower) {m_Followers.push_back(Follower);}
+
+    std::vector<WriteTask *> & GetFollowers() {return(m_Followers);}
+
+    void SetNoReplyTicket(uint64_t Ticket) {m_NoReplyTicket=Ticket;}
+
+    virtual work_result operator()();
+
 };  // class WriteTask
 
 
 /**
  * Background object for async get,
+ *  optionally shared by concurrent gets of the same key (see
+ *  DbObjectOptions::m_CoalesceGets)
  */
 
 class GetTask : public WorkTask
@@ -174,45 +230,412 @@ class GetTask : public WorkTask
 protected:
     std::string                        m_Key;
     rocksdb::ReadOptions*              options;
+    bool                               m_ZeroCopy;  //!< return value as resource binary
+    bool                               m_Coalesced; //!< registered in DbObject::m_InFlightGets
+    std::string                        m_InFlightKey; //!< m_InFlightGets key when coalesced
+
+    // additional callers attached while this task was queued,
+    //  only modified under DbObject::m_InFlightMutex
+    ErlNifEnv *                        m_WaiterEnv;
+    std::vector<std::pair<ErlNifPid, ERL_NIF_TERM> > m_Waiters;
 
 public:
     GetTask(ErlNifEnv *_caller_env,
             ERL_NIF_TERM _caller_ref,
             DbObject *_db_handle,
             ERL_NIF_TERM _key_term,
-            rocksdb::ReadOptions *_options)
+            rocksdb::ReadOptions *_options,
+            bool _zero_copy=false,
+            bool _coalesced=false)
         : WorkTask(_caller_env, _caller_ref, _db_handle),
-        options(_options)
+        options(_options), m_ZeroCopy(_zero_copy), m_Coalesced(_coalesced),
+        m_WaiterEnv(NULL)
         {
             ErlNifBinary key;
 
             enif_inspect_binary(_caller_env, _key_term, &key);
             m_Key.assign((const char *)key.data, key.size);
+
+            if (m_Coalesced)
+                m_InFlightKey=InFlightKey(*options, m_ZeroCopy, m_Key);
         }
 
     virtual ~GetTask()
+    {
+        delete options;
+
+        if (NULL!=m_WaiterEnv)
+            enif_free_env(m_WaiterEnv);
+    }
+
+    // gets only share a task when their results are built the same way,
+    //  so the read options that change them are part of the key
+    static std::string InFlightKey(const rocksdb::ReadOptions & Options, bool ZeroCopy,
+                                   const rocksdb::Slice & Key)
+    {
+        std::string ret_str;
+
+        ret_str.reserve(3 + Key.size());
+        ret_str.push_back(Options.verify_checksums ? '1' : '0');
+        ret_str.push_back(Options.fill_cache ? '1' : '0');
+        ret_str.push_back(ZeroCopy ? '1' : '0');
+        ret_str.append(Key.data(), Key.size());
+
+        return(ret_str);
+    }
+
+    // caller must hold DbObject::m_InFlightMutex
+    void AddWaiter(ErlNifEnv * CallerEnv, const ERL_NIF_TERM & CallerRef);
+
+    // caller must hold DbObject::m_InFlightMutex
+    size_t WaiterCount() const {return(m_Waiters.size());};
+
+    // sends {CallerRef, Result} to every waiter, returns the count of
+    //  failed sends.  m_Waiters must be frozen:  task left m_InFlightGets
+    size_t NotifyWaiters(const ERL_NIF_TERM & Result);
+
+    virtual work_result operator()();
+
+protected:
+    work_result DoGet();
+
+};  // class GetTask
+
+
+
+/**
+ * Background object for async multi get,
+ *  one DB::MultiGet (single implicit snapshot) for a list of keys
+ */
+
+class MultiGetTask : public WorkTask
+{
+protected:
+    std::vector<std::string>           m_Keys;
+    rocksdb::ReadOptions*              options;
+    bool                               m_ZeroCopy;  //!< return values as resource binaries
+
+public:
+    MultiGetTask(ErlNifEnv *_caller_env,
+                 ERL_NIF_TERM _caller_ref,
+                 DbObject *_db_handle,
+                 ERL_NIF_TERM _keys_term,
+                 rocksdb::ReadOptions *_options,
+                 bool _zero_copy=false)
+        : WorkTask(_caller_env, _caller_ref, _db_handle),
+        options(_options), m_ZeroCopy(_zero_copy)
+        {
+            ERL_NIF_TERM head, tail;
+            ErlNifBinary key;
+
+            // caller already validated list contains only binaries
+            tail=_keys_term;
+            while (enif_get_list_cell(_caller_env, tail, &head, &tail))
+            {
+                enif_inspect_binary(_caller_env, head, &key);
+                m_Keys.push_back(std::string((const char *)key.data, key.size));
+            }   // while
+        }
+
+    virtual ~MultiGetTask()
     {
         delete options;
     }
 
     virtual work_result operator()()
     {
-        ERL_NIF_TERM value_bin;
-        std::string value;
-        rocksdb::Slice key_slice(m_Key);
+        std::vector<rocksdb::Slice> key_slices;
+        std::vector<std::string> values;
+        std::vector<rocksdb::Status> statuses;
+        std::vector<ERL_NIF_TERM> results;
+        size_t loop;
+
+        key_slices.reserve(m_Keys.size());
+        for (loop=0; loop<m_Keys.size(); ++loop)
+            key_slices.push_back(rocksdb::Slice(m_Keys[loop]));
+
+        statuses=m_DbPtr->m_Db->MultiGet(*options, key_slices, &values);
+
+        results.reserve(m_Keys.size());
+        for (loop=0; loop<statuses.size(); ++loop)
+        {
+            if (statuses[loop].ok())
+            {
+                ERL_NIF_TERM value_bin;
+
+                if (m_ZeroCopy)
+                {
+                    // take over the string's buffer, no byte copy
+                    ValueObject * value_ptr=ValueObject::CreateValueObject();
+                    value_ptr->m_Value.swap(values[loop]);
+                    value_bin=value_ptr->MakeBinary(local_env());
+                }   // if
+                else
+                {
+                    unsigned char* v = enif_make_new_binary(local_env(), values[loop].size(), &value_bin);
+                    memcpy(v, values[loop].data(), values[loop].size());
+                }   // else
+
+                results.push_back(enif_make_tuple2(local_env(), ATOM_OK, value_bin));
+            }   // if
+            else
+            {
+                results.push_back(ATOM_NOT_FOUND);
+            }   // else
+        }   // for
+
+        return work_result(enif_make_list_from_array(local_env(),
+                                                     results.empty() ? NULL : &results[0],
+                                                     results.size()));
+    }
+
+};  // class MultiGetTask
+
+
+
+/**
+ * Background object for async delete of all keys in [Start, End).
+ *  Keys are found with an iterator and deleted in bounded batches
+ *  so neither keys nor one huge batch pass through Erlang.  Each run
+ *  writes one batch and resubmits, so long ranges share the worker
+ *  threads with other tasks.
+ */
 
-        rocksdb::Status status = m_DbPtr->m_Db->Get(*options, key_slice, &value);
+class DeleteRangeTask : public WorkTask
+{
+protected:
+    std::string             m_Start;
+    std::string             m_End;
+    rocksdb::WriteOptions*  options;
+    bool                    m_Compact;   //!< CompactRange over the span when done
 
-        if(!status.ok())
-            return work_result(ATOM_NOT_FOUND);
+    rocksdb::Slice m_UpperSlice;        //!< iterate_upper_bound points here
+    rocksdb::Iterator * m_Iterator;     //!< position between runs
+    uint64_t    m_Deleted;
 
-        unsigned char* v = enif_make_new_binary(local_env(), value.size(), &value_bin);
-        memcpy(v, value.c_str(), value.size());
+public:
+    DeleteRangeTask(ErlNifEnv *_caller_env,
+                    ERL_NIF_TERM _caller_ref,
+                    DbObject *_db_handle,
+                    const rocksdb::Slice & _start,
+                    const rocksdb::Slice & _end,
+                    rocksdb::WriteOptions *_options,
+                    bool _compact)
+        : WorkTask(_caller_env, _caller_ref, _db_handle),
+        m_Start(_start.data(), _start.size()), m_End(_end.data(), _end.size()),
+        options(_options), m_Compact(_compact),
+        m_Iterator(NULL), m_Deleted(0)
+        {
+            m_UpperSlice=rocksdb::Slice(m_End);
+        }
 
-        return work_result(local_env(), ATOM_OK, value_bin);
+    // iterator goes before m_DbPtr releases the database
+    virtual ~DeleteRangeTask()
+    {
+        delete m_Iterator;
+        delete options;
     }
 
-};  // class GetTask
+    virtual work_result operator()();
+
+};  // class DeleteRangeTask
+
+
+/**
+ * Background object ending a {bulk_load, true} session:  flushes the
+ *  WAL-less memtables, compacts everything and restores the dynamic
+ *  options bulk load changed
+ */
+
+class FinishBulkLoadTask : public WorkTask
+{
+public:
+    FinishBulkLoadTask(ErlNifEnv *_caller_env,
+                       ERL_NIF_TERM _caller_ref,
+                       DbObject *_db_handle)
+        : WorkTask(_caller_env, _caller_ref, _db_handle)
+        {}
+
+    virtual ~FinishBulkLoadTask() {}
+
+    virtual work_result operator()();
+
+};  // class FinishBulkLoadTask
+
+
+/**
+ * Background object for compare-and-set put.  The read, compare and
+ *  write run under the key's stripe lock in DbObject, so they are
+ *  atomic with respect to other put_if calls.  A busy stripe does not
+ *  block the worker thread, the task parks on the stripe and its owner
+ *  hands it over to the pool when done.
+ */
+
+class PutIfTask : public WorkTask
+{
+protected:
+    std::string             m_Key;
+    std::string             m_Expected;
+    bool                    m_ExpectNotFound;
+    std::string             m_Value;
+    rocksdb::WriteOptions*  options;
+    bool                    m_OwnsStripe;  //!< stripe was handed over while parked
+
+public:
+    PutIfTask(ErlNifEnv *_caller_env,
+              ERL_NIF_TERM _caller_ref,
+              DbObject *_db_handle,
+              const rocksdb::Slice & _key,
+              const rocksdb::Slice * _expected,   // NULL: key must not exist
+              const rocksdb::Slice & _value,
+              rocksdb::WriteOptions *_options)
+        : WorkTask(_caller_env, _caller_ref, _db_handle),
+        m_Key(_key.data(), _key.size()), m_ExpectNotFound(NULL==_expected),
+        m_Value(_value.data(), _value.size()), options(_options),
+        m_OwnsStripe(false)
+        {
+            if (NULL!=_expected)
+                m_Expected.assign(_expected->data(), _expected->size());
+
+            // same as WriteTask, finish_bulk_load's flush makes it durable
+            if (_db_handle->m_ObjectOptions.m_BulkLoad)
+                options->disableWAL=true;
+        }
+
+    virtual ~PutIfTask()
+    {
+        delete options;
+    }
+
+    virtual work_result operator()();
+
+protected:
+    // caller holds the key's stripe lock
+    work_result DoPutIf();
+
+};  // class PutIfTask
+
+
+/**
+ * Background object cutting a key range into shards of about equal
+ *  size for parallel scans.  Cut points are chosen among the boundary
+ *  keys of the live SST files, weighted with GetApproximateSizes.
+ */
+
+class SplitRangeTask : public WorkTask
+{
+protected:
+    std::string m_Start;
+    std::string m_End;
+    bool        m_HasEnd;    //!< false scans to the last key
+    unsigned    m_Shards;
+
+public:
+    SplitRangeTask(ErlNifEnv *_caller_env,
+                   ERL_NIF_TERM _caller_ref,
+                   DbObject *_db_handle,
+                   const rocksdb::Slice & _start,
+                   const rocksdb::Slice * _end,
+                   unsigned _shards)
+        : WorkTask(_caller_env, _caller_ref, _db_handle),
+        m_Start(_start.data(), _start.size()),
+        m_HasEnd(NULL!=_end), m_Shards(_shards)
+        {
+            if (NULL!=_end)
+                m_End.assign(_end->data(), _end->size());
+        }
+
+    virtual ~SplitRangeTask() {}
+
+    virtual work_result operator()();
+
+};  // class SplitRangeTask
+
+
+/**
+ * Background object sending one chunk of a StreamObject's range to its
+ *  consumer per run.  Resubmits itself while credits remain, so long
+ *  exports share the worker threads with other tasks.
+ */
+
+class StreamTask : public WorkTask
+{
+protected:
+    StreamObject * m_Stream;                        //!< holds a resource reference
+    ReferencePtr<RocksIteratorWrapper> m_ItrWrap;   //!< NULL when the iterator was already closed
+
+public:
+    StreamTask(ERL_NIF_TERM _stream_ref,
+               StreamObject * _stream,
+               RocksIteratorWrapper * IterWrap)
+        : WorkTask(NULL, _stream_ref), m_Stream(_stream), m_ItrWrap(IterWrap)
+        {
+            enif_keep_resource(m_Stream);
+        }
+
+    virtual ~StreamTask()
+    {
+        enif_release_resource(m_Stream);
+    }
+
+    // replies go out as stream messages, never to a caller ref
+    virtual work_result operator()();
+
+protected:
+    bool Send(ErlNifEnv * MsgEnv, ERL_NIF_TERM Payload);
+
+};  // class StreamTask
+
+
+/**
+ * Background object counting the keys of a range.  Exact counts walk
+ *  an iterator without copying keys out, resubmitting every
+ *  COUNT_KEYS_PER_RUN keys.  Estimates add whole files inside the range
+ *  by their entry counts and size the rest with GetApproximateSizes.
+ */
+
+class CountRangeTask : public WorkTask
+{
+protected:
+    std::string m_Start;
+    std::string m_End;
+    bool        m_HasEnd;    //!< false counts to the last key
+    bool        m_Exact;
+
+    rocksdb::Slice m_UpperSlice;        //!< iterate_upper_bound points here
+    rocksdb::Iterator * m_Iterator;     //!< exact count position between runs
+    uint64_t    m_Count;
+
+public:
+    CountRangeTask(ErlNifEnv *_caller_env,
+                   ERL_NIF_TERM _caller_ref,
+                   DbObject *_db_handle,
+                   const rocksdb::Slice & _start,
+                   const rocksdb::Slice * _end,
+                   bool _exact)
+        : WorkTask(_caller_env, _caller_ref, _db_handle),
+        m_Start(_start.data(), _start.size()),
+        m_HasEnd(NULL!=_end), m_Exact(_exact),
+        m_Iterator(NULL), m_Count(0)
+        {
+            if (NULL!=_end)
+                m_End.assign(_end->data(), _end->size());
+            m_UpperSlice=rocksdb::Slice(m_End);
+        }
+
+    // iterator goes before m_DbPtr releases the database
+    virtual ~CountRangeTask()
+    {
+        delete m_Iterator;
+    }
+
+    virtual work_result operator()();
+
+protected:
+    work_result CountExact();
+    work_result Estimate();
+
+};  // class CountRangeTask
 
 
 
@@ -226,15 +649,20 @@ protected:
 
     const bool keys_only;
     rocksdb::ReadOptions *options;
+    IterateBounds bounds;
+    ReferencePtr<RocksSnapshotWrapper> shared_snapshot; //!< NULL to take a new snapshot
 
 public:
     IterTask(ErlNifEnv *_caller_env,
              ERL_NIF_TERM _caller_ref,
              DbObject *_db_handle,
              const bool _keys_only,
-             rocksdb::ReadOptions *_options)
+             rocksdb::ReadOptions *_options,
+             const IterateBounds & _bounds,
+             RocksSnapshotWrapper * _shared_snapshot=NULL)
         : WorkTask(_caller_env, _caller_ref, _db_handle),
-        keys_only(_keys_only), options(_options)
+        keys_only(_keys_only), options(_options), bounds(_bounds),
+        shared_snapshot(_shared_snapshot)
     {}
 
     virtual ~IterTask()
@@ -252,18 +680,31 @@ public:
         // NOTE: transfering ownership of options to ItrObject
         itr_ptr=ItrObject::CreateItrObject(m_DbPtr.get(), keys_only, options);
 
-        snapshot = m_DbPtr->m_Db->GetSnapshot();
-        itr_ptr->m_Snapshot.assign(new RocksSnapshotWrapper(m_DbPtr.get(), snapshot));
+        // parallel scans read several iterators from one snapshot
+        if (NULL!=shared_snapshot.get())
+        {
+            itr_ptr->m_Snapshot.assign(shared_snapshot.get());
+            snapshot = shared_snapshot->get();
+        }   // if
+        else
+        {
+            snapshot = m_DbPtr->m_Db->GetSnapshot();
+            itr_ptr->m_Snapshot.assign(new RocksSnapshotWrapper(m_DbPtr.get(), snapshot));
+        }   // else
         options->snapshot = snapshot;
 
+        // wrapper owns the bound bytes, so it exists before the iterator
+        itr_ptr->m_Iter.assign(new RocksIteratorWrapper(m_DbPtr.get(), itr_ptr->m_Snapshot.get(),
+                                                        NULL, keys_only));
+        itr_ptr->m_Iter->SetBounds(bounds, *options);
+
         // Copy caller_ref to reuse in future iterator_move calls
-        itr_ptr->m_Snapshot->itr_ref_env = enif_alloc_env();
-        itr_ptr->m_Snapshot->itr_ref = enif_make_copy(itr_ptr->m_Snapshot->itr_ref_env,
-                                                      caller_ref());
+        itr_ptr->m_Iter->itr_ref_env = enif_alloc_env();
+        itr_ptr->m_Iter->itr_ref = enif_make_copy(itr_ptr->m_Iter->itr_ref_env,
+                                                  caller_ref());
 
         iterator = m_DbPtr->m_Db->NewIterator(*options);
-        itr_ptr->m_Iter.assign(new RocksIteratorWrapper(m_DbPtr.get(), itr_ptr->m_Snapshot.get(),
-                                                        iterator, keys_only));
+        itr_ptr->m_Iter->m_Iterator = iterator;
 
         ERL_NIF_TERM result = enif_make_resource(local_env(), itr_ptr);
 
@@ -280,7 +721,7 @@ public:
 class MoveTask : public WorkTask
 {
 public:
-    typedef enum { FIRST, LAST, NEXT, PREV, SEEK, PREFETCH } action_t;
+    typedef enum { FIRST, LAST, NEXT, PREV, SEEK, PREFETCH, SCAN, PARKED } action_t;
 
 protected:
     ReferencePtr<RocksIteratorWrapper> m_ItrWrap;             //!< access to database, and holds reference
@@ -288,6 +729,11 @@ protected:
 public:
     action_t                                       action;
     std::string                                 seek_target;
+    unsigned                                    batch_count;  //!< entries per NEXT/PREV/SCAN reply, 0 is single move
+    action_t                                    scan_from;    //!< SCAN positions with FIRST, SEEK or NEXT
+    uint32_t                                    prefetch_generation; //!< PREFETCH is stale once this differs
+    std::string                                 scan_end;     //!< SCAN stops before this key
+    bool                                        has_scan_end;
 
 public:
 
@@ -295,7 +741,9 @@ public:
     MoveTask(ErlNifEnv *_caller_env, ERL_NIF_TERM _caller_ref,
              RocksIteratorWrapper * IterWrap, action_t& _action)
         : WorkTask(NULL, _caller_ref),
-        m_ItrWrap(IterWrap), action(_action)
+        m_ItrWrap(IterWrap), action(_action), batch_count(0),
+        scan_from(NEXT), prefetch_generation(IterWrap->m_PrefetchGeneration),
+        has_scan_end(false)
     {
         // special case construction
         local_env_=NULL;
@@ -308,7 +756,9 @@ public:
              std::string& _seek_target)
         : WorkTask(NULL, _caller_ref),
         m_ItrWrap(IterWrap), action(_action),
-        seek_target(_seek_target)
+        seek_target(_seek_target), batch_count(0),
+        scan_from(NEXT), prefetch_generation(IterWrap->m_PrefetchGeneration),
+        has_scan_end(false)
         {
             // special case construction
             local_env_=NULL;
@@ -323,6 +773,14 @@ public:
     virtual void prepare_recycle();
     virtual void recycle();
 
+    bool SetScanRange(ErlNifEnv * Env, ERL_NIF_TERM From, ERL_NIF_TERM End);
+
+protected:
+    work_result MoveBatch(rocksdb::Iterator * itr);
+    work_result ScanChunk(rocksdb::Iterator * itr);
+    work_result Prefetch(rocksdb::Iterator * itr);
+    work_result EntryResult(rocksdb::Iterator * itr);
+
 };  // class MoveTask
 
 } // namespace erocksdb
@@ -26,15 +26,36 @@
 
 -export([open/3, open_with_cf/3, close/1]).
 -export([list_column_families/2, create_column_family/3, drop_column_family/2]).
--export([put/4, put/5, delete/3, delete/4, write/3, get/3, get/4]).
+-export([put/4, put/5, delete/3, delete/4, write/3, get/3, get/4, multi_get/3]).
 -export([iterator/2, iterator/3, iterator_with_cf/3, iterator_move/2, iterator_close/1]).
 -export([fold/4, fold/5, fold_keys/4, fold_keys/5]).
+-export([fold_range/5, fold_keys_range/5]).
+-export([split_range/4, parallel_fold/5]).
+-export([stream_range/5, stream_ack/2, stream_close/1]).
 -export([destroy/2, repair/2, is_empty/1]).
--export([count/1, count/2, status/1, status/2, status/3]).
+-export([key_may_exist/3, keys_may_exist/3]).
+-export([new_cache/2, cache_info/1]).
+-export([new_rate_limiter/1, set_rate_limit/2]).
+-export([read_options/1, write_options/1]).
+-export([subscribe_events/1, unsubscribe_events/1]).
+-export([batch/0, batch_put/3, batch_delete/2, batch_clear/1, batch_count/1, batch_data_size/1,
+         write_batch/3]).
+-export([write_packed/3, pack_write_actions/1]).
+-export([delete_range/4]).
+-export([finish_bulk_load/1]).
+-export([put_if/5]).
+-export([write_watermark/1, subscribe_write_watermark/1, unsubscribe_write_watermark/1]).
+-export([count/1, count/2, count_range/4, status/1, status/2, status/3]).
 
 -export_type([db_handle/0,
               cf_handle/0,
               itr_handle/0,
+              cache_handle/0,
+              batch_handle/0,
+              rate_limiter_handle/0,
+              stream_handle/0,
+              read_options_handle/0,
+              write_options_handle/0,
               compression_type/0,
               compaction_style/0,
               access_hint/0]).
@@ -51,6 +72,9 @@
 -include_lib("eunit/include/eunit.hrl").
 -endif.
 
+%% entries per iterator_move call of fold and fold_keys
+-define(FOLD_BATCH_SIZE, 512).
+
 %% This cannot be a separate function. Code must be inline to trigger
 %% Erlang compiler's use of optimized selective receive.
 -define(WAIT_FOR_REPLY(Ref),
@@ -83,9 +107,22 @@ init() ->
 -type compaction_style() :: level | universal | fifo | none.
 -type access_hint() :: normal | sequential | willneed | none.
 
+%% uint64_add: operands and values are <<N:64/unsigned-little>>, any
+%%             other size makes reads of the key fail as corruption
+%% {append, Delimiter}: operand is appended after Delimiter
+%% set_union: operands and values are ascending, duplicate free
+%%            sequences of <<Len:32/big, Element:Len/binary>>
+-type merge_operator() :: uint64_add | {append, binary()} | set_union.
+
 -opaque db_handle() :: binary().
 -opaque cf_handle() :: binary().
 -opaque itr_handle() :: binary().
+-opaque cache_handle() :: binary().
+-opaque batch_handle() :: binary().
+-opaque rate_limiter_handle() :: binary().
+-opaque stream_handle() :: binary().
+-opaque read_options_handle() :: binary().
+-opaque write_options_handle() :: binary().
 
 -type cf_options() :: [{block_cache_size_mb_for_point_lookup, non_neg_integer()} |
                        {memtable_memory_budget, pos_integer()} |
@@ -117,9 +154,14 @@ init() ->
                        {inplace_update_support,  boolean()} |
                        {inplace_update_num_locks,  pos_integer()} |
                        {table_factory_block_cache_size, pos_integer()} |
+                       {block_cache, cache_handle()} |
+                       {block_cache_statistics, boolean()} |
+                       {merge_operator, merge_operator()} |
+                       {bulk_load, boolean()} |
                        {in_memory_mode, boolean()}].
 
 -type db_options() :: [{total_threads, pos_integer()} |
+                       {rate_limiter, rate_limiter_handle()} |
                        {create_if_missing, boolean()} |
                        {create_missing_column_families, boolean()} |
                        {error_if_exists, boolean()} |
@@ -151,26 +193,48 @@ init() ->
                        {advise_random_on_open, boolean()} |
                        {access_hint, access_hint()} |
                        {use_adaptive_mutex, boolean()} |
-                       {bytes_per_sync, non_neg_integer()}].
+                       {bytes_per_sync, non_neg_integer()} |
+                       {coalesce_gets, boolean()}].
 
--type read_options() :: [{verify_checksums, boolean()} |
+%% option lists, or handles from read_options/1 and write_options/1
+-type read_options() :: read_option_list() | read_options_handle().
+-type read_option_list() :: [{verify_checksums, boolean()} |
                          {fill_cache, boolean()} |
                          {iterate_upper_bound, binary()} |
+                         {iterate_lower_bound, binary()} |
                          {tailing, boolean()} |
-                         {total_order_seek, boolean()}].
+                         {total_order_seek, boolean()} |
+                         {zero_copy, boolean()}].
+
+-type write_options() :: write_option_list() | write_options_handle().
 
--type write_options() :: [{sync, boolean()} |
+-type write_option_list() :: [{sync, boolean()} |
                           {disable_wal, boolean()} |
                           {timeout_hint_us, non_neg_integer()} |
-                          {ignore_missing_column_families, boolean()}].
+                          {ignore_missing_column_families, boolean()} |
+                          {noreply, boolean()} |
+                          {compact_range, boolean()}].
 
 -type write_actions() :: [{put, Key::binary(), Value::binary()} |
                           {put, ColumnFamilyHandle::cf_handle(), Key::binary(), Value::binary()} |
+                          {merge, Key::binary(), Operand::binary()} |
                           {delete, Key::binary()} |
                           {delete, ColumnFamilyHandle::cf_handle(), Key::binary()} |
                           clear].
 
--type iterator_action() :: first | last | next | prev | binary().
+%% start is inclusive and defaults to the first key,
+%% end is exclusive and defaults to past the last key
+-type fold_range() :: [{start, binary()} | {'end', binary()}].
+
+-type shard() :: {Start::binary(), End::binary() | undefined}.
+
+-type stream_option() :: {credits, non_neg_integer()} |
+                         {chunk_size, pos_integer()} |
+                         keys_only |
+                         {read_options, read_options()}.
+
+-type iterator_action() :: first | last | next | prev | binary() |
+                           {next, pos_integer()} | {prev, pos_integer()}.
 
 async_open(_CallerRef, _Name, _DBOpts, _CFOpts) ->
     erlang:nif_error({error, not_loaded}).
@@ -278,13 +342,166 @@ async_write(_CallerRef, _DBHandle, _WriteActions, _WriteOpts) ->
 
 %% @doc
 %% Apply the specified updates to the database.
+%% With {noreply, true} the call returns {ok, Ticket} without waiting.
+%% The write is committed once write_watermark/1 reaches Ticket.
+%% merge actions raise badarg on a database opened without merge_operator.
 -spec(write(DBHandle, WriteActions, WriteOpts) ->
-             ok | {error, any()} when DBHandle::db_handle(),
-                                      WriteActions::write_actions(),
-                                      WriteOpts::write_options()).
+             ok | {ok, non_neg_integer()} | {error, any()} when DBHandle::db_handle(),
+                                                                WriteActions::write_actions(),
+                                                                WriteOpts::write_options()).
 write(DBHandle, WriteActions, WriteOpts) ->
     CallerRef = make_ref(),
-    async_write(CallerRef, DBHandle, WriteActions, WriteOpts),
+    case async_write(CallerRef, DBHandle, WriteActions, WriteOpts) of
+        ok -> ?WAIT_FOR_REPLY(CallerRef);
+        Reply -> Reply
+    end.
+
+%% @doc
+%% Return {Watermark, Failed}: every noreply write with a ticket up to
+%% Watermark has completed, and Failed of them returned an error.
+-spec(write_watermark(DBHandle) ->
+             {non_neg_integer(), non_neg_integer()} when DBHandle::db_handle()).
+write_watermark(_DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Receive {erocksdb_write_watermark, Watermark, Failed} messages as
+%% noreply writes complete. Messages are batched, one per 256 tickets or
+%% whenever all issued writes have completed.
+-spec(subscribe_write_watermark(DBHandle) -> ok when DBHandle::db_handle()).
+subscribe_write_watermark(_DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+-spec(unsubscribe_write_watermark(DBHandle) -> ok when DBHandle::db_handle()).
+unsubscribe_write_watermark(_DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Create an empty write batch. Operations are encoded as they are
+%% added, write_batch/3 commits them without walking an action list.
+-spec(batch() -> {ok, batch_handle()}).
+batch() ->
+    erlang:nif_error({error, not_loaded}).
+
+-spec(batch_put(Batch, Key, Value) ->
+             ok when Batch::batch_handle(), Key::binary(), Value::binary()).
+batch_put(_Batch, _Key, _Value) ->
+    erlang:nif_error({error, not_loaded}).
+
+-spec(batch_delete(Batch, Key) -> ok when Batch::batch_handle(), Key::binary()).
+batch_delete(_Batch, _Key) ->
+    erlang:nif_error({error, not_loaded}).
+
+-spec(batch_clear(Batch) -> ok when Batch::batch_handle()).
+batch_clear(_Batch) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Number of operations in the batch
+-spec(batch_count(Batch) -> non_neg_integer() when Batch::batch_handle()).
+batch_count(_Batch) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Size in bytes of the encoded batch
+-spec(batch_data_size(Batch) -> non_neg_integer() when Batch::batch_handle()).
+batch_data_size(_Batch) ->
+    erlang:nif_error({error, not_loaded}).
+
+async_write_batch(_CallerRef, _DBHandle, _Batch, _WriteOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Commit the contents of a batch. The batch is left unchanged.
+%% {noreply, true} works as in write/3, {compact_range, true} raises badarg.
+-spec(write_batch(DBHandle, Batch, WriteOpts) ->
+             ok | {ok, non_neg_integer()} | {error, any()} when DBHandle::db_handle(),
+                                                                Batch::batch_handle(),
+                                                                WriteOpts::write_options()).
+write_batch(DBHandle, Batch, WriteOpts) ->
+    CallerRef = make_ref(),
+    case async_write_batch(CallerRef, DBHandle, Batch, WriteOpts) of
+        ok -> ?WAIT_FOR_REPLY(CallerRef);
+        Reply -> Reply
+    end.
+
+async_write_packed(_CallerRef, _DBHandle, _Packed, _WriteOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Apply updates encoded with pack_write_actions/1. The binary is
+%% decoded in one pass instead of walking an action list.
+%% {noreply, true} works as in write/3, {compact_range, true} raises badarg.
+-spec(write_packed(DBHandle, Packed, WriteOpts) ->
+             ok | {ok, non_neg_integer()} | {error, any()} when DBHandle::db_handle(),
+                                                                Packed::binary(),
+                                                                WriteOpts::write_options()).
+write_packed(DBHandle, Packed, WriteOpts) ->
+    CallerRef = make_ref(),
+    case async_write_packed(CallerRef, DBHandle, Packed, WriteOpts) of
+        ok -> ?WAIT_FOR_REPLY(CallerRef);
+        Reply -> Reply
+    end.
+
+%% @doc
+%% Encode put/delete actions for write_packed/3
+-spec(pack_write_actions(WriteActions) -> binary() when WriteActions::write_actions()).
+pack_write_actions(WriteActions) ->
+    iolist_to_binary([pack_write_action(A) || A <- WriteActions]).
+
+pack_write_action({put, Key, Value}) ->
+    [<<1, (byte_size(Key)):32/big>>, Key, <<(byte_size(Value)):32/big>>, Value];
+pack_write_action({delete, Key}) ->
+    [<<0, (byte_size(Key)):32/big>>, Key].
+
+async_delete_range(_CallerRef, _DBHandle, _Start, _End, _WriteOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Delete every key K with Start =< K < End in a background task and
+%% return the number of keys deleted. With {compact_range, true} in
+%% WriteOpts the span is compacted afterward to drop the tombstones.
+-spec(delete_range(DBHandle, Start, End, WriteOpts) ->
+             {ok, non_neg_integer()} | {error, any()} when DBHandle::db_handle(),
+                                                           Start::binary(),
+                                                           End::binary(),
+                                                           WriteOpts::write_options()).
+delete_range(DBHandle, Start, End, WriteOpts) ->
+    CallerRef = make_ref(),
+    async_delete_range(CallerRef, DBHandle, Start, End, WriteOpts),
+    ?WAIT_FOR_REPLY(CallerRef).
+
+async_finish_bulk_load(_CallerRef, _DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% End a {bulk_load, true} session. Call this after every bulk write has
+%% returned. It flushes the memtables written without WAL, restores the
+%% auto compaction and level 0 trigger settings given to open/3 and
+%% compacts the whole database. After an error it may be called again.
+-spec(finish_bulk_load(DBHandle) -> ok | {error, any()} when DBHandle::db_handle()).
+finish_bulk_load(DBHandle) ->
+    CallerRef = make_ref(),
+    async_finish_bulk_load(CallerRef, DBHandle),
+    ?WAIT_FOR_REPLY(CallerRef).
+
+async_put_if(_CallerRef, _DBHandle, _Key, _Expected, _Value, _WriteOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Put Value only if Key currently holds Expected, or does not exist
+%% when Expected is not_found. Otherwise return the current value.
+%% The check and the put are atomic with respect to other put_if
+%% calls on the database, not with respect to plain writes.
+-spec(put_if(DBHandle, Key, Expected, Value, WriteOpts) ->
+             ok | {conflict, binary() | not_found} | {error, any()} when DBHandle::db_handle(),
+                                                                       Key::binary(),
+                                                                       Expected::binary() | not_found,
+                                                                       Value::binary(),
+                                                                       WriteOpts::write_options()).
+put_if(DBHandle, Key, Expected, Value, WriteOpts) ->
+    CallerRef = make_ref(),
+    async_put_if(CallerRef, DBHandle, Key, Expected, Value, WriteOpts),
     ?WAIT_FOR_REPLY(CallerRef).
 
 async_get(_CallerRef, _DBHandle, _Key, _ReadOpts) ->
@@ -298,8 +515,13 @@ async_get(_CallerRef, _DBHandle, _Key, _ReadOpts) ->
                                                               ReadOpts::read_options()).
 get(DBHandle, Key, ReadOpts) ->
     CallerRef = make_ref(),
-    async_get(CallerRef, DBHandle, Key, ReadOpts),
-    ?WAIT_FOR_REPLY(CallerRef).
+    case async_get(CallerRef, DBHandle, Key, ReadOpts) of
+        ok ->
+            ?WAIT_FOR_REPLY(CallerRef);
+        %% served inline from memtable / block cache
+        Reply ->
+            Reply
+    end.
 
 %% @doc
 %% Retrieve a key/value pair in the specified column family
@@ -311,6 +533,21 @@ get(DBHandle, Key, ReadOpts) ->
 get(_DBHandle, _CFHandle, _Key, _ReadOpts) ->
     {error, not_implemeted}.
 
+async_multi_get(_CallerRef, _DBHandle, _Keys, _ReadOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Retrieve a list of keys in the default column family with a single
+%% DB::MultiGet (one implicit snapshot). Results are in the order of Keys.
+-spec(multi_get(DBHandle, Keys, ReadOpts) ->
+             [{ok, binary()} | not_found] | {error, any()} when DBHandle::db_handle(),
+                                                                Keys::[binary()],
+                                                                ReadOpts::read_options()).
+multi_get(DBHandle, Keys, ReadOpts) ->
+    CallerRef = make_ref(),
+    async_multi_get(CallerRef, DBHandle, Keys, ReadOpts),
+    ?WAIT_FOR_REPLY(CallerRef).
+
 async_iterator(_CallerRef, _DBHandle, _ReadOpts) ->
     erlang:nif_error({error, not_loaded}).
 
@@ -343,14 +580,26 @@ iterator(DBHandle, ReadOpts, keys_only) ->
 iterator_with_cf(_DBHandle, _CFHandle, _ReadOpts) ->
     {error, not_implemeted}.
 
+async_iterator_from(_CallerRef, _ITRHandle, _ReadOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% new iterator on the snapshot of ITRHandle
+iterator_from(ITRHandle, ReadOpts) ->
+    CallerRef = make_ref(),
+    async_iterator_from(CallerRef, ITRHandle, ReadOpts),
+    ?WAIT_FOR_REPLY(CallerRef).
+
 async_iterator_move(_CallerRef, _ITRHandle, _ITRAction) ->
     erlang:nif_error({error, not_loaded}).
 
 %% @doc
-%% Move to the specified place
+%% Move to the specified place.  {next, N} and {prev, N} move up to N
+%% times in one call and return the entries passed as one list, fewer
+%% than N when the end is reached or the reply grows past 1MB.
 -spec(iterator_move(ITRHandle, ITRAction) ->
              {ok, Key::binary(), Value::binary()} |
              {ok, Key::binary()} |
+             {ok, [{Key::binary(), Value::binary()}] | [Key::binary()]} |
              {error, invalid_iterator} |
              {error, iterator_closed} when ITRHandle::itr_handle(),
                                            ITRAction::iterator_action()).
@@ -435,9 +684,214 @@ fold_keys(DBHandle, Fun, Acc0, ReadOpts) ->
 fold_keys(_DBHandle, _CFHandle, _Fun, _Acc0, _ReadOpts) ->
     _Acc0.
 
+%% @doc
+%% Calls Fun(Elem, AccIn) on the elements of a key range of the default
+%% column family.  Entries are collected natively in chunks.  Fun may
+%% return {stop, Acc} to end the fold early, which closes the iterator
+%% and releases its snapshot at once.
+-spec(fold_range(DBHandle, Fun, Acc0, ReadOpts, Range) ->
+             any() when DBHandle::db_handle(),
+                        Fun::fold_fun(),
+                        Acc0::any(),
+                        ReadOpts::read_options(),
+                        Range::fold_range()).
+fold_range(DBHandle, Fun, Acc0, ReadOpts, Range) ->
+    {ok, Itr} = iterator(DBHandle, range_read_options(ReadOpts, Range)),
+    do_fold_range(Itr, Fun, Acc0, Range).
+
+%% @doc
+%% Keys only version of fold_range/5
+-spec(fold_keys_range(DBHandle, Fun, Acc0, ReadOpts, Range) ->
+             any() when DBHandle::db_handle(),
+                        Fun::fold_keys_fun(),
+                        Acc0::any(),
+                        ReadOpts::read_options(),
+                        Range::fold_range()).
+fold_keys_range(DBHandle, Fun, Acc0, ReadOpts, Range) ->
+    {ok, Itr} = iterator(DBHandle, range_read_options(ReadOpts, Range), keys_only),
+    do_fold_range(Itr, Fun, Acc0, Range).
+
+async_split_range(_CallerRef, _DBHandle, _Start, _End, _N) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Cut the keys Start =< K < End into at most N contiguous shards of
+%% about equal size on disk.  End undefined means up to the last key.
+%% Cut points are SST file boundaries, so data still in the memtable or
+%% a database with few files yields fewer shards.
+-spec(split_range(DBHandle, Start, End, N) ->
+             {ok, [shard()]} | {error, any()} when DBHandle::db_handle(),
+                                                  Start::binary(),
+                                                  End::binary() | undefined,
+                                                  N::pos_integer()).
+split_range(DBHandle, Start, End, N) ->
+    CallerRef = make_ref(),
+    async_split_range(CallerRef, DBHandle, Start, End, N),
+    ?WAIT_FOR_REPLY(CallerRef).
+
+%% @doc
+%% Fold over the whole default column family in up to N shards from
+%% split_range/4.  Every shard is folded in its own process with its own
+%% iterator, all on one snapshot, starting from Acc0.  Returns the shard
+%% accumulators in key order.  Fun may return {stop, Acc} as in
+%% fold_range/5, which ends only its own shard.
+-spec(parallel_fold(DBHandle, Fun, Acc0, ReadOpts, N) ->
+             [any()] when DBHandle::db_handle(),
+                          Fun::fold_fun(),
+                          Acc0::any(),
+                          ReadOpts::read_options(),
+                          N::pos_integer()).
+parallel_fold(DBHandle, Fun, Acc0, ReadOpts, N) ->
+    {ok, Shards} = split_range(DBHandle, <<>>, undefined, N),
+    {ok, Itr} = iterator(DBHandle, ReadOpts),
+    Workers = [spawn_shard_fold(Itr, Fun, Acc0, ReadOpts, Shard) || Shard <- Shards],
+    try
+        [await_shard_fold(Worker) || Worker <- Workers]
+    after
+        %% a failed shard must not leave the others folding
+        [kill_shard_fold(Worker) || Worker <- Workers],
+        iterator_close(Itr)
+    end.
+
+%% @doc
+%% Export the keys Start =< K < End to Pid, End undefined means up to
+%% the last key.  A worker sends {erocksdb_stream, Stream, {data, Entries}}
+%% messages of up to chunk_size entries, each using one credit, then
+%% {erocksdb_stream, Stream, done} or {erocksdb_stream, Stream, {error, Reason}}.
+%% Without credits the stream pauses, holding only its iterator, until
+%% Pid grants more with stream_ack/2.  Options:
+%%   {credits, N}          initial credits, default 1
+%%   {chunk_size, N}       entries per message, default 512
+%%   keys_only             entries are keys instead of {Key, Value}
+%%   {read_options, Opts}  default []
+-spec(stream_range(DBHandle, Start, End, Pid, Opts) ->
+             {ok, stream_handle()} | {error, any()} when DBHandle::db_handle(),
+                                                         Start::binary(),
+                                                         End::binary() | undefined,
+                                                         Pid::pid(),
+                                                         Opts::[stream_option()]).
+stream_range(DBHandle, Start, End, Pid, Opts) ->
+    Range = [{'end', End} || End =/= undefined],
+    ReadOpts = range_read_options(proplists:get_value(read_options, Opts, []), Range),
+    Result = case proplists:get_bool(keys_only, Opts) of
+                 true -> iterator(DBHandle, ReadOpts, keys_only);
+                 false -> iterator(DBHandle, ReadOpts)
+             end,
+    case Result of
+        {ok, Itr} ->
+            stream_open(Itr, Start, End, Pid,
+                        proplists:get_value(credits, Opts, 1),
+                        proplists:get_value(chunk_size, Opts, ?FOLD_BATCH_SIZE));
+        Error ->
+            Error
+    end.
+
+stream_open(_ITRHandle, _Start, _End, _Pid, _Credits, _ChunkSize) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Allow N more data messages of a stream.  Credits after the stream
+%% ended are ignored.
+-spec(stream_ack(Stream, N) -> ok | {error, any()} when Stream::stream_handle(),
+                                                        N::non_neg_integer()).
+stream_ack(_Stream, _N) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Stop a stream and release its iterator and snapshot.  Messages
+%% already sent stay in the consumer's mailbox.
+-spec(stream_close(Stream) -> ok when Stream::stream_handle()).
+stream_close(_Stream) ->
+    erlang:nif_error({error, not_loaded}).
+
 is_empty(_DBHandle) ->
     erlang:nif_error({error, not_loaded}).
 
+%% @doc
+%% Check from memtable and filter blocks only, without disk I/O, whether
+%% Key may exist. false is definite, true may be a false positive.
+-spec(key_may_exist(DBHandle, Key, ReadOpts) ->
+             boolean() when DBHandle::db_handle(),
+                            Key::binary(),
+                            ReadOpts::read_options()).
+key_may_exist(_DBHandle, _Key, _ReadOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Batched key_may_exist/3, one boolean per key in the order of Keys.
+%% Keys holds at most 1024 keys, longer lists raise badarg.
+-spec(keys_may_exist(DBHandle, Keys, ReadOpts) ->
+             [boolean()] when DBHandle::db_handle(),
+                              Keys::[binary()],
+                              ReadOpts::read_options()).
+keys_may_exist(_DBHandle, _Keys, _ReadOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Create an LRU cache that can be shared by many databases through the
+%% {block_cache, Cache} column family option. The option replaces the
+%% private cache of table_factory_block_cache_size and cannot be combined
+%% with in_memory_mode.  Databases that also set
+%% {block_cache_statistics, true} turn on rocksdb statistics, with their
+%% per operation cost, and count their hits and misses in the cache.
+-spec(new_cache(Capacity, NumShardBits) ->
+             {ok, cache_handle()} when Capacity::non_neg_integer(),
+                                       NumShardBits::0..19).
+new_cache(_Capacity, _NumShardBits) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Return capacity and usage in bytes and hit/miss counts of a shared cache.
+%% Hits and misses are summed over the databases opened with
+%% {block_cache_statistics, true}, other users of the cache are not counted.
+-spec(cache_info(Cache) ->
+             [{capacity | usage | hits | misses, non_neg_integer()}] when Cache::cache_handle()).
+cache_info(_Cache) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Receive {erocksdb_event, Event} messages from the database's
+%% background work, where Event is one of:
+%%   {flush_completed, CfName, FilePath}
+%%   {compaction_completed, CfName, BytesIn, BytesOut, OutputLevel}
+%%   {write_stall_begin, slowdown | stop}
+%%   write_stall_end
+-spec(subscribe_events(DBHandle) -> ok when DBHandle::db_handle()).
+subscribe_events(_DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+-spec(unsubscribe_events(DBHandle) -> ok when DBHandle::db_handle()).
+unsubscribe_events(_DBHandle) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Create a limiter for flush and compaction writes that can be shared
+%% by many databases through the {rate_limiter, Limiter} db option.
+-spec(new_rate_limiter(BytesPerSec) ->
+             {ok, rate_limiter_handle()} when BytesPerSec::pos_integer()).
+new_rate_limiter(_BytesPerSec) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Change the rate of a limiter, including for already open databases
+-spec(set_rate_limit(Limiter, BytesPerSec) ->
+             ok when Limiter::rate_limiter_handle(), BytesPerSec::pos_integer()).
+set_rate_limit(_Limiter, _BytesPerSec) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Parse read options once.  The handle is accepted wherever a read
+%% option list is and saves re-parsing the list on every call.
+-spec(read_options(ReadOpts) -> {ok, read_options_handle()} when ReadOpts::read_option_list()).
+read_options(_ReadOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Parse write options once, see read_options/1
+-spec(write_options(WriteOpts) -> {ok, write_options_handle()} when WriteOpts::write_option_list()).
+write_options(_WriteOpts) ->
+    erlang:nif_error({error, not_loaded}).
+
 %% @doc
 %% Destroy the contents of the specified database.
 %% Be very careful using this method.
@@ -479,6 +933,30 @@ count(DBHandle) ->
 count(_DBHandle, _CFHandle) ->
     {error, not_implemeted}.
 
+async_count_range(_CallerRef, _DBHandle, _Start, _End, _Mode) ->
+    erlang:nif_error({error, not_loaded}).
+
+%% @doc
+%% Return the number of keys Start =< K < End, End undefined means up
+%% to the last key.  exact walks the range natively without sending
+%% keys to Erlang.  estimate counts SST files inside the range by their
+%% entries and sizes the rest with GetApproximateSizes, keys still in
+%% the memtable are not included.
+-spec(count_range(DBHandle, Start, End, Mode) ->
+             non_neg_integer() | {error, any()} when DBHandle::db_handle(),
+                                                     Start::binary(),
+                                                     End::binary() | undefined,
+                                                     Mode::exact | estimate).
+count_range(DBHandle, Start, End, Mode) ->
+    CallerRef = make_ref(),
+    async_count_range(CallerRef, DBHandle, Start, End, Mode),
+    case ?WAIT_FOR_REPLY(CallerRef) of
+        {ok, Count} ->
+            Count;
+        Error ->
+            Error
+    end.
+
 %% @doc
 %% Return the current status of the default column family
 %% Implemented by calling GetProperty with "rocksdb.stats"
@@ -489,8 +967,9 @@ status(DBHandle) ->
     status(DBHandle, <<"rocksdb.stats">>).
 
 %% @doc
-%% Return the RocksDB internal status of the default column family specified at Property
-%%
+%% Return the RocksDB internal status of the default column family specified at Property.
+%% <<"erocksdb.coalesced-gets">> is the number of gets that {coalesce_gets, true}
+%% answered from another caller's lookup.
 -spec(status(DBHandle, Property) ->
              {ok, any()} | {error, any()} when DBHandle::db_handle(),
                                                Property::binary()).
@@ -521,12 +1000,77 @@ fold_loop({error, iterator_closed}, _Itr, _Fun, Acc0) ->
     throw({iterator_closed, Acc0});
 fold_loop({error, invalid_iterator}, _Itr, _Fun, Acc0) ->
     Acc0;
+fold_loop({ok, Entries}, Itr, Fun, Acc0) when is_list(Entries) ->
+    Acc = lists:foldl(Fun, Acc0, Entries),
+    fold_loop(iterator_move(Itr, {next, ?FOLD_BATCH_SIZE}), Itr, Fun, Acc);
 fold_loop({ok, K}, Itr, Fun, Acc0) ->
     Acc = Fun(K, Acc0),
-    fold_loop(iterator_move(Itr, next), Itr, Fun, Acc);
+    fold_loop(iterator_move(Itr, {next, ?FOLD_BATCH_SIZE}), Itr, Fun, Acc);
 fold_loop({ok, K, V}, Itr, Fun, Acc0) ->
     Acc = Fun({K, V}, Acc0),
-    fold_loop(iterator_move(Itr, next), Itr, Fun, Acc).
+    fold_loop(iterator_move(Itr, {next, ?FOLD_BATCH_SIZE}), Itr, Fun, Acc).
+
+%% the end key also becomes the iterator's upper bound so rocksdb stops
+%% there, unless the caller's own bound is smaller, handles keep their
+%% own bounds
+range_read_options(ReadOpts, Range) when is_list(ReadOpts) ->
+    case lists:keyfind('end', 1, Range) of
+        {'end', End} ->
+            Bound = case lists:keyfind(iterate_upper_bound, 1, ReadOpts) of
+                        {iterate_upper_bound, Upper} when Upper < End -> Upper;
+                        _ -> End
+                    end,
+            [{iterate_upper_bound, Bound} |
+             [Opt || Opt <- ReadOpts, not is_tuple(Opt) orelse element(1, Opt) =/= iterate_upper_bound]];
+        false -> ReadOpts
+    end;
+range_read_options(ReadOpts, _Range) ->
+    ReadOpts.
+
+spawn_shard_fold(Itr, Fun, Acc0, ReadOpts, {Start, End}) ->
+    Range = [{start, Start} | [{'end', End} || End =/= undefined]],
+    spawn_monitor(fun() ->
+                          {ok, ShardItr} = iterator_from(Itr, range_read_options(ReadOpts, Range)),
+                          exit({shard_fold, do_fold_range(ShardItr, Fun, Acc0, Range)})
+                  end).
+
+await_shard_fold({Pid, MRef}) ->
+    receive
+        {'DOWN', MRef, process, Pid, {shard_fold, Acc}} -> Acc;
+        {'DOWN', MRef, process, Pid, Reason} -> erlang:error(Reason)
+    end.
+
+%% no-op for a shard that already finished
+kill_shard_fold({Pid, MRef}) ->
+    erlang:demonitor(MRef, [flush]),
+    exit(Pid, kill).
+
+do_fold_range(Itr, Fun, Acc0, Range) ->
+    From = proplists:get_value(start, Range, first),
+    End = proplists:get_value('end', Range, undefined),
+    try
+        range_loop(iterator_move(Itr, {scan, From, End, ?FOLD_BATCH_SIZE}), Itr, Fun, Acc0, End)
+    after
+        iterator_close(Itr)
+    end.
+
+range_loop({error, iterator_closed}, _Itr, _Fun, Acc0, _End) ->
+    throw({iterator_closed, Acc0});
+range_loop({Status, Entries}, Itr, Fun, Acc0, End) ->
+    case fold_entries(Fun, Acc0, Entries) of
+        {stop, Acc} -> Acc;
+        {cont, Acc} when Status =:= done -> Acc;
+        {cont, Acc} ->
+            range_loop(iterator_move(Itr, {scan, next, End, ?FOLD_BATCH_SIZE}), Itr, Fun, Acc, End)
+    end.
+
+fold_entries(_Fun, Acc, []) ->
+    {cont, Acc};
+fold_entries(Fun, Acc0, [Entry | Rest]) ->
+    case Fun(Entry, Acc0) of
+        {stop, Acc} -> {stop, Acc};
+        Acc -> fold_entries(Fun, Acc, Rest)
+    end.
 
 %% ===================================================================
 %% EUnit tests
@@ -546,6 +1090,488 @@ open_test_Z() ->
     not_found = ?MODULE:get(Ref, <<"abc">>, []),
     true = ?MODULE:is_empty(Ref).
 
+multi_get_test() -> [{multi_get_test_Z(), l} || l <- lists:seq(1, 20)].
+multi_get_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.multi_get.test"),
+    {ok, Ref} = open("/tmp/erocksdb.multi_get.test", [{create_if_missing, true}], []),
+    ok = ?MODULE:put(Ref, <<"abc">>, <<"123">>, []),
+    ok = ?MODULE:put(Ref, <<"hij">>, <<"789">>, []),
+    [{ok, <<"123">>}, not_found, {ok, <<"789">>}] =
+        ?MODULE:multi_get(Ref, [<<"abc">>, <<"def">>, <<"hij">>], []),
+    [] = ?MODULE:multi_get(Ref, [], []).
+
+zero_copy_get_test() -> [{zero_copy_get_test_Z(), l} || l <- lists:seq(1, 20)].
+zero_copy_get_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.zero_copy.test"),
+    {ok, Ref} = open("/tmp/erocksdb.zero_copy.test", [{create_if_missing, true}], []),
+    Big = list_to_binary([I rem 256 || I <- lists:seq(1, 65536)]),
+    ok = ?MODULE:put(Ref, <<"big">>, Big, []),
+    {ok, Big} = ?MODULE:get(Ref, <<"big">>, [{zero_copy, true}]),
+    not_found = ?MODULE:get(Ref, <<"none">>, [{zero_copy, true}]),
+    [{ok, Big}, not_found] = ?MODULE:multi_get(Ref, [<<"big">>, <<"none">>], [{zero_copy, true}]).
+
+coalesce_gets_test() -> [{coalesce_gets_test_Z(), l} || l <- lists:seq(1, 20)].
+coalesce_gets_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.coalesce_gets.test"),
+    {ok, Ref} = open("/tmp/erocksdb.coalesce_gets.test",
+                     [{create_if_missing, true}, {coalesce_gets, true}], []),
+    ok = ?MODULE:put(Ref, <<"abc">>, <<"123">>, []),
+    %% reopening flushes the memtable, without fill_cache the block never
+    %% gets cached and every get needs a GetTask
+    ok = close(Ref),
+    {ok, Ref1} = open("/tmp/erocksdb.coalesce_gets.test", [{coalesce_gets, true}], []),
+    {ok, <<"0">>} = status(Ref1, <<"erocksdb.coalesced-gets">>),
+    true = coalesce_gets_burst(Ref1, 100),
+    %% other read options never share a task
+    {ok, <<"123">>} = ?MODULE:get(Ref1, <<"abc">>, [{fill_cache, true}]),
+    not_found = ?MODULE:get(Ref1, <<"def">>, [{fill_cache, false}]),
+    ok = close(Ref1).
+
+%% concurrent gets until some were attached to a queued GetTask
+coalesce_gets_burst(_Ref, 0) ->
+    false;
+coalesce_gets_burst(Ref, Tries) ->
+    Self = self(),
+    Pids = [spawn(fun() -> Self ! {self(), ?MODULE:get(Ref, <<"abc">>, [{fill_cache, false}])} end) ||
+               _ <- lists:seq(1, 50)],
+    [receive {Pid, Reply} -> {ok, <<"123">>} = Reply end || Pid <- Pids],
+    case status(Ref, <<"erocksdb.coalesced-gets">>) of
+        {ok, <<"0">>} -> coalesce_gets_burst(Ref, Tries - 1);
+        {ok, _} -> true
+    end.
+
+key_may_exist_test() -> [{key_may_exist_test_Z(), l} || l <- lists:seq(1, 20)].
+key_may_exist_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.key_may_exist.test"),
+    {ok, Ref} = open("/tmp/erocksdb.key_may_exist.test", [{create_if_missing, true}], []),
+    ok = ?MODULE:put(Ref, <<"abc">>, <<"123">>, []),
+    true = ?MODULE:key_may_exist(Ref, <<"abc">>, []),
+    [true, _] = ?MODULE:keys_may_exist(Ref, [<<"abc">>, <<"def">>], []),
+    [] = ?MODULE:keys_may_exist(Ref, [], []),
+    1024 = length(?MODULE:keys_may_exist(Ref, lists:duplicate(1024, <<"abc">>), [])),
+    {'EXIT', {badarg, _}} = (catch ?MODULE:keys_may_exist(Ref, lists:duplicate(1025, <<"abc">>), [])).
+
+shared_cache_test() -> [{shared_cache_test_Z(), l} || l <- lists:seq(1, 20)].
+shared_cache_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.shared_cache.0 /tmp/erocksdb.shared_cache.1"),
+    {ok, Cache} = new_cache(8 * 1024 * 1024, 4),
+    {'EXIT', {badarg, _}} = (catch new_cache(1024, 20)),
+    {'EXIT', {badarg, _}} = (catch new_cache(1024, -1)),
+    {ok, Ref0} = open("/tmp/erocksdb.shared_cache.0", [{create_if_missing, true}],
+                      [{block_cache, Cache}]),
+    {ok, Ref1} = open("/tmp/erocksdb.shared_cache.1", [{create_if_missing, true}],
+                      [{block_cache, Cache}, {block_cache_statistics, true}]),
+    ok = ?MODULE:put(Ref0, <<"abc">>, <<"123">>, []),
+    ok = ?MODULE:put(Ref1, <<"abc">>, <<"456">>, []),
+    {ok, <<"123">>} = ?MODULE:get(Ref0, <<"abc">>, []),
+    {ok, <<"456">>} = ?MODULE:get(Ref1, <<"abc">>, []),
+    Info = cache_info(Cache),
+    8388608 = proplists:get_value(capacity, Info),
+    true = is_integer(proplists:get_value(hits, Info)),
+    %% a plain table has no block cache to share
+    {'EXIT', {badarg, _}} = (catch open("/tmp/erocksdb.shared_cache.2", [{create_if_missing, true}],
+                                        [{block_cache, Cache}, {in_memory_mode, true}])),
+    ok = close(Ref0),
+    ok = close(Ref1).
+
+group_commit_test() -> [{group_commit_test_Z(), l} || l <- lists:seq(1, 20)].
+group_commit_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.group_commit.test"),
+    {ok, Ref} = open("/tmp/erocksdb.group_commit.test", [{create_if_missing, true}], []),
+    Self = self(),
+    Keys = [<<N:32>> || N <- lists:seq(1, 200)],
+    Pids = [spawn_link(fun() ->
+                               Self ! {self(), ?MODULE:put(Ref, K, K, [{sync, N rem 2 =:= 0}])}
+                       end) || {N, K} <- lists:zip(lists:seq(1, 200), Keys)],
+    [receive {Pid, Result} -> ok = Result end || Pid <- Pids],
+    [{ok, K} = ?MODULE:get(Ref, K, []) || K <- Keys],
+    ok = close(Ref).
+
+write_batch_test() -> [{write_batch_test_Z(), l} || l <- lists:seq(1, 20)].
+write_batch_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.write_batch.test"),
+    {ok, Ref} = open("/tmp/erocksdb.write_batch.test", [{create_if_missing, true}], []),
+    {ok, Batch} = batch(),
+    ok = batch_put(Batch, <<"a">>, <<"1">>),
+    ok = batch_put(Batch, <<"b">>, <<"2">>),
+    ok = batch_delete(Batch, <<"a">>),
+    3 = batch_count(Batch),
+    true = batch_data_size(Batch) > 0,
+    ok = write_batch(Ref, Batch, []),
+    not_found = ?MODULE:get(Ref, <<"a">>, []),
+    {ok, <<"2">>} = ?MODULE:get(Ref, <<"b">>, []),
+    ok = subscribe_write_watermark(Ref),
+    {ok, 1} = write_batch(Ref, Batch, [{noreply, true}]),
+    receive
+        {erocksdb_write_watermark, 1, 0} -> ok
+    after 5000 ->
+            erlang:error(no_watermark)
+    end,
+    {'EXIT', {badarg, _}} = (catch write_batch(Ref, Batch, [{compact_range, true}])),
+    ok = batch_clear(Batch),
+    0 = batch_count(Batch),
+    ok = close(Ref).
+
+write_packed_test() -> [{write_packed_test_Z(), l} || l <- lists:seq(1, 20)].
+write_packed_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.write_packed.test"),
+    {ok, Ref} = open("/tmp/erocksdb.write_packed.test", [{create_if_missing, true}], []),
+    Packed = pack_write_actions([{put, <<"a">>, <<"1">>},
+                                 {put, <<"b">>, <<"2">>},
+                                 {delete, <<"a">>}]),
+    ok = write_packed(Ref, Packed, []),
+    not_found = ?MODULE:get(Ref, <<"a">>, []),
+    {ok, <<"2">>} = ?MODULE:get(Ref, <<"b">>, []),
+    {'EXIT', {badarg, _}} = (catch write_packed(Ref, <<1, 0, 0, 0, 9, "ab">>, [])),
+    ok = subscribe_write_watermark(Ref),
+    {ok, 1} = write_packed(Ref, Packed, [{noreply, true}]),
+    receive
+        {erocksdb_write_watermark, 1, 0} -> ok
+    after 5000 ->
+            erlang:error(no_watermark)
+    end,
+    {'EXIT', {badarg, _}} = (catch write_packed(Ref, Packed, [{compact_range, true}])),
+    ok = close(Ref).
+
+noreply_write_test() -> [{noreply_write_test_Z(), l} || l <- lists:seq(1, 20)].
+noreply_write_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.noreply_write.test"),
+    {ok, Ref} = open("/tmp/erocksdb.noreply_write.test", [{create_if_missing, true}], []),
+    ok = subscribe_write_watermark(Ref),
+    Tickets = [begin
+                   {ok, T} = write(Ref, [{put, <<N:32>>, <<N:32>>}], [{noreply, true}]),
+                   T
+               end || N <- lists:seq(1, 100)],
+    Last = lists:last(Tickets),
+    100 = Last,
+    receive
+        {erocksdb_write_watermark, Last, 0} -> ok
+    after 5000 ->
+            erlang:error(no_watermark)
+    end,
+    {Last, 0} = write_watermark(Ref),
+    {ok, <<100:32>>} = ?MODULE:get(Ref, <<100:32>>, []),
+    ok = unsubscribe_write_watermark(Ref),
+    ok = close(Ref).
+
+merge_operator_test() -> [{merge_operator_test_Z(), l} || l <- lists:seq(1, 20)].
+merge_operator_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.merge_operator.test"),
+    os:cmd("rm -rf /tmp/erocksdb.merge_operator.test.1"),
+    os:cmd("rm -rf /tmp/erocksdb.merge_operator.test.2"),
+    {ok, Counter} = open("/tmp/erocksdb.merge_operator.test", [{create_if_missing, true}],
+                         [{merge_operator, uint64_add}]),
+    ok = write(Counter, [{merge, <<"c">>, <<1:64/unsigned-little>>},
+                         {merge, <<"c">>, <<2:64/unsigned-little>>}], []),
+    ok = write(Counter, [{merge, <<"c">>, <<3:64/unsigned-little>>}], []),
+    {ok, <<6:64/unsigned-little>>} = ?MODULE:get(Counter, <<"c">>, []),
+    %% a malformed operand is an error, not a reset counter
+    ok = write(Counter, [{merge, <<"bad">>, <<1:32>>}], []),
+    {error, _} = ?MODULE:get(Counter, <<"bad">>, []),
+    ok = close(Counter),
+    {ok, Append} = open("/tmp/erocksdb.merge_operator.test.1", [{create_if_missing, true}],
+                        [{merge_operator, {append, <<",">>}}]),
+    ok = write(Append, [{merge, <<"l">>, <<"a">>}, {merge, <<"l">>, <<"b">>}], []),
+    {ok, <<"a,b">>} = ?MODULE:get(Append, <<"l">>, []),
+    ok = close(Append),
+    {ok, Set} = open("/tmp/erocksdb.merge_operator.test.2", [{create_if_missing, true}],
+                     [{merge_operator, set_union}]),
+    Enc = fun(Elems) -> << <<(byte_size(E)):32/big, E/binary>> || E <- Elems >> end,
+    ok = write(Set, [{merge, <<"s">>, Enc([<<"a">>, <<"c">>])},
+                     {merge, <<"s">>, Enc([<<"b">>, <<"c">>])}], []),
+    Expected = Enc([<<"a">>, <<"b">>, <<"c">>]),
+    {ok, Expected} = ?MODULE:get(Set, <<"s">>, []),
+    ok = close(Set),
+    %% no merge operator, no merges
+    os:cmd("rm -rf /tmp/erocksdb.merge_operator.test.3"),
+    {ok, Plain} = open("/tmp/erocksdb.merge_operator.test.3", [{create_if_missing, true}], []),
+    {'EXIT', {badarg, _}} = (catch write(Plain, [{merge, <<"l">>, <<"c">>}], [])),
+    ok = close(Plain).
+
+delete_range_test() -> [{delete_range_test_Z(), l} || l <- lists:seq(1, 20)].
+delete_range_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.delete_range.test"),
+    {ok, Ref} = open("/tmp/erocksdb.delete_range.test", [{create_if_missing, true}], []),
+    ok = write(Ref, [{put, <<N:32>>, <<N:32>>} || N <- lists:seq(1, 3000)], []),
+    {ok, 2000} = delete_range(Ref, <<501:32>>, <<2501:32>>, [{compact_range, true}]),
+    {ok, <<500:32>>} = ?MODULE:get(Ref, <<500:32>>, []),
+    not_found = ?MODULE:get(Ref, <<501:32>>, []),
+    not_found = ?MODULE:get(Ref, <<2500:32>>, []),
+    {ok, <<2501:32>>} = ?MODULE:get(Ref, <<2501:32>>, []),
+    {ok, 0} = delete_range(Ref, <<501:32>>, <<2501:32>>, []),
+    ok = close(Ref).
+
+bulk_load_test() -> [{bulk_load_test_Z(), l} || l <- lists:seq(1, 20)].
+bulk_load_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.bulk_load.test"),
+    {ok, Ref} = open("/tmp/erocksdb.bulk_load.test", [{create_if_missing, true}],
+                     [{bulk_load, true}]),
+    [ok = ?MODULE:put(Ref, <<N:32>>, <<N:32>>, []) || N <- lists:seq(1, 1000)],
+    ok = finish_bulk_load(Ref),
+    {ok, <<1000:32>>} = ?MODULE:get(Ref, <<1000:32>>, []),
+    ok = close(Ref),
+    {ok, Ref1} = open("/tmp/erocksdb.bulk_load.test", [], []),
+    {ok, <<1:32>>} = ?MODULE:get(Ref1, <<1:32>>, []),
+    ok = close(Ref1).
+
+rate_limiter_test() -> [{rate_limiter_test_Z(), l} || l <- lists:seq(1, 20)].
+rate_limiter_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.rate_limiter.test"),
+    {ok, Limiter} = new_rate_limiter(10 * 1024 * 1024),
+    {ok, Ref} = open("/tmp/erocksdb.rate_limiter.test",
+                     [{create_if_missing, true}, {rate_limiter, Limiter}], []),
+    ok = ?MODULE:put(Ref, <<"abc">>, <<"123">>, []),
+    ok = set_rate_limit(Limiter, 1024 * 1024),
+    ok = ?MODULE:put(Ref, <<"def">>, <<"456">>, []),
+    {ok, <<"456">>} = ?MODULE:get(Ref, <<"def">>, []),
+    {'EXIT', {badarg, _}} = (catch set_rate_limit(Limiter, 0)),
+    ok = close(Ref).
+
+events_test() -> [{events_test_Z(), l} || l <- lists:seq(1, 20)].
+events_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.events.test"),
+    {ok, Ref} = open("/tmp/erocksdb.events.test", [{create_if_missing, true}],
+                     [{write_buffer_size, 65536}]),
+    ok = subscribe_events(Ref),
+    Value = list_to_binary(lists:duplicate(1024, $x)),
+    [ok = ?MODULE:put(Ref, <<N:32>>, Value, []) || N <- lists:seq(1, 256)],
+    receive
+        {erocksdb_event, {flush_completed, <<"default">>, _}} -> ok
+    after 10000 ->
+            erlang:error(no_flush_event)
+    end,
+    ok = unsubscribe_events(Ref),
+    ok = close(Ref).
+
+put_if_test() -> [{put_if_test_Z(), l} || l <- lists:seq(1, 20)].
+put_if_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.put_if.test"),
+    {ok, Ref} = open("/tmp/erocksdb.put_if.test", [{create_if_missing, true}], []),
+    ok = put_if(Ref, <<"k">>, not_found, <<"1">>, []),
+    {conflict, <<"1">>} = put_if(Ref, <<"k">>, not_found, <<"2">>, []),
+    {conflict, <<"1">>} = put_if(Ref, <<"k">>, <<"0">>, <<"2">>, []),
+    ok = put_if(Ref, <<"k">>, <<"1">>, <<"2">>, []),
+    {conflict, not_found} = put_if(Ref, <<"other">>, <<"1">>, <<"2">>, []),
+    %% concurrent increments through put_if never lose an update
+    Self = self(),
+    Incr = fun Loop() ->
+                   {ok, <<N:32>>} = case ?MODULE:get(Ref, <<"n">>, []) of
+                                        not_found -> {ok, <<0:32>>};
+                                        Found -> Found
+                                    end,
+                   Expected = case N of 0 -> not_found; _ -> <<N:32>> end,
+                   case put_if(Ref, <<"n">>, Expected, <<(N + 1):32>>, []) of
+                       ok -> ok;
+                       {conflict, _} -> Loop()
+                   end
+           end,
+    Pids = [spawn_link(fun() -> Self ! {self(), Incr()} end) || _ <- lists:seq(1, 50)],
+    [receive {Pid, ok} -> ok end || Pid <- Pids],
+    {ok, <<50:32>>} = ?MODULE:get(Ref, <<"n">>, []),
+    ok = close(Ref).
+
+iterator_batch_test() -> [{iterator_batch_test_Z(), l} || l <- lists:seq(1, 20)].
+iterator_batch_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.iterator_batch.test"),
+    {ok, Ref} = open("/tmp/erocksdb.iterator_batch.test", [{create_if_missing, true}], []),
+    Keys = [<<N:32>> || N <- lists:seq(1, 10)],
+    [ok = put(Ref, K, K, []) || K <- Keys],
+    {ok, Itr} = iterator(Ref, []),
+    {ok, <<1:32>>, <<1:32>>} = iterator_move(Itr, first),
+    {ok, Batch} = iterator_move(Itr, {next, 4}),
+    [{<<N:32>>, <<N:32>>} || N <- lists:seq(2, 5)] = Batch,
+    {ok, Rest} = iterator_move(Itr, {next, 100}),
+    5 = length(Rest),
+    {error, invalid_iterator} = iterator_move(Itr, {next, 100}),
+    {ok, <<10:32>>, <<10:32>>} = iterator_move(Itr, last),
+    {ok, [{<<9:32>>, _}, {<<8:32>>, _}]} = iterator_move(Itr, {prev, 2}),
+    {'EXIT', {badarg, _}} = (catch iterator_move(Itr, {next, 0})),
+    ok = iterator_close(Itr),
+    {ok, KeysItr} = iterator(Ref, [], keys_only),
+    {ok, <<1:32>>} = iterator_move(KeysItr, first),
+    {ok, [<<2:32>>, <<3:32>>]} = iterator_move(KeysItr, {next, 2}),
+    ok = iterator_close(KeysItr),
+    Keys = lists:reverse(fold_keys(Ref, fun(K, Acc) -> [K | Acc] end, [], [])),
+    ok = close(Ref).
+
+fold_range_test() -> [{fold_range_test_Z(), l} || l <- lists:seq(1, 20)].
+fold_range_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.fold_range.test"),
+    {ok, Ref} = open("/tmp/erocksdb.fold_range.test", [{create_if_missing, true}], []),
+    [ok = put(Ref, <<N:32>>, <<N:32>>, []) || N <- lists:seq(1, 2000)],
+    Collect = fun(KV, Acc) -> [KV | Acc] end,
+    Range = fun(Opts) -> lists:reverse(fold_keys_range(Ref, Collect, [], [], Opts)) end,
+    [<<N:32>> || N <- lists:seq(1, 2000)] = Range([]),
+    [<<N:32>> || N <- lists:seq(100, 1199)] = Range([{start, <<100:32>>}, {'end', <<1200:32>>}]),
+    [<<N:32>> || N <- lists:seq(1990, 2000)] = Range([{start, <<1990:32>>}]),
+    [] = Range([{start, <<5:32>>}, {'end', <<5:32>>}]),
+    %% the caller's smaller upper bound wins over the range end
+    [<<N:32>> || N <- lists:seq(100, 149)] =
+        lists:reverse(fold_keys_range(Ref, Collect, [], [{iterate_upper_bound, <<150:32>>}],
+                                      [{start, <<100:32>>}, {'end', <<1200:32>>}])),
+    [<<N:32>> || N <- lists:seq(100, 199)] =
+        lists:reverse(fold_keys_range(Ref, Collect, [], [{iterate_upper_bound, <<1500:32>>}],
+                                      [{start, <<100:32>>}, {'end', <<200:32>>}])),
+    [{<<1:32>>, <<1:32>>}, {<<2:32>>, <<2:32>>}] =
+        lists:reverse(fold_range(Ref, Collect, [], [], [{'end', <<3:32>>}])),
+    %% {stop, Acc} ends the fold early
+    10 = fold_keys_range(Ref, fun(_K, 10) -> {stop, 10};
+                                 (_K, Acc) -> Acc + 1
+                              end, 0, [], []),
+    ok = close(Ref).
+
+count_range_test() -> [{count_range_test_Z(), l} || l <- lists:seq(1, 20)].
+count_range_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.count_range.test"),
+    {ok, Ref} = open("/tmp/erocksdb.count_range.test", [{create_if_missing, true}],
+                     [{write_buffer_size, 64 * 1024}]),
+    Value = list_to_binary(lists:duplicate(100, $v)),
+    [ok = put(Ref, <<N:32>>, Value, []) || N <- lists:seq(1, 20000)],
+    20000 = count_range(Ref, <<>>, undefined, exact),
+    1000 = count_range(Ref, <<1001:32>>, <<2001:32>>, exact),
+    0 = count_range(Ref, <<2:32>>, <<2:32>>, exact),
+    0 = count_range(Ref, <<30000:32>>, undefined, exact),
+    Estimate = count_range(Ref, <<>>, undefined, estimate),
+    true = is_integer(Estimate) andalso Estimate =< 20000,
+    true = count_range(Ref, <<1:32>>, <<10001:32>>, estimate) =< Estimate,
+    ok = close(Ref).
+
+stream_range_test() -> [{stream_range_test_Z(), l} || l <- lists:seq(1, 20)].
+stream_range_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.stream_range.test"),
+    {ok, Ref} = open("/tmp/erocksdb.stream_range.test", [{create_if_missing, true}], []),
+    [ok = put(Ref, <<N:32>>, <<N:32>>, []) || N <- lists:seq(1, 10)],
+    {ok, S} = stream_range(Ref, <<2:32>>, <<9:32>>, self(), [{chunk_size, 3}]),
+    {erocksdb_stream, S, {data, [{<<2:32>>, _}, {<<3:32>>, _}, {<<4:32>>, _}]}} = stream_recv(),
+    %% paused until credits arrive
+    timeout = stream_recv(),
+    ok = stream_ack(S, 5),
+    {erocksdb_stream, S, {data, [{<<5:32>>, _}, {<<6:32>>, _}, {<<7:32>>, _}]}} = stream_recv(),
+    {erocksdb_stream, S, {data, [{<<8:32>>, _}]}} = stream_recv(),
+    {erocksdb_stream, S, done} = stream_recv(),
+    ok = stream_ack(S, 1),
+    timeout = stream_recv(),
+    {ok, K} = stream_range(Ref, <<>>, undefined, self(), [keys_only, {credits, 10}, {chunk_size, 5}]),
+    {erocksdb_stream, K, {data, [<<1:32>>, <<2:32>>, <<3:32>>, <<4:32>>, <<5:32>>]}} = stream_recv(),
+    {erocksdb_stream, K, {data, [<<6:32>>, <<7:32>>, <<8:32>>, <<9:32>>, <<10:32>>]}} = stream_recv(),
+    {erocksdb_stream, K, done} = stream_recv(),
+    %% a closed stream sends nothing more and close still works
+    {ok, C} = stream_range(Ref, <<>>, undefined, self(), [{credits, 0}, {chunk_size, 1}]),
+    ok = stream_close(C),
+    ok = stream_ack(C, 1),
+    timeout = stream_recv(),
+    ok = close(Ref).
+
+stream_recv() ->
+    receive {erocksdb_stream, _, _} = Msg -> Msg
+    after 200 -> timeout
+    end.
+
+parallel_fold_test() -> [{parallel_fold_test_Z(), l} || l <- lists:seq(1, 20)].
+parallel_fold_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.parallel_fold.test"),
+    {ok, Ref} = open("/tmp/erocksdb.parallel_fold.test", [{create_if_missing, true}],
+                     [{write_buffer_size, 64 * 1024}]),
+    Value = list_to_binary(lists:duplicate(100, $v)),
+    Keys = [<<N:32>> || N <- lists:seq(1, 5000)],
+    [ok = put(Ref, K, Value, []) || K <- Keys],
+    {ok, Shards} = split_range(Ref, <<>>, undefined, 4),
+    true = length(Shards) =< 4,
+    {<<>>, _} = hd(Shards),
+    {_, undefined} = lists:last(Shards),
+    {ok, [{<<10:32>>, <<20:32>>}]} = split_range(Ref, <<10:32>>, <<20:32>>, 1),
+    %% writes after the fold started are not seen by any shard
+    Counts = parallel_fold(Ref, fun({K, _V}, Acc) ->
+                                        ok = put(Ref, <<K/binary, "x">>, Value, []),
+                                        Acc + 1
+                                end, 0, [], 4),
+    5000 = lists:sum(Counts),
+    Collected = parallel_fold(Ref, fun({K, _V}, Acc) -> [K | Acc] end, [], [], 4),
+    AllKeys = lists:append([lists:reverse(Acc) || Acc <- Collected]),
+    AllKeys = lists:sort(AllKeys),
+    10000 = length(AllKeys),
+    %% one failing shard takes the others down with it
+    Self = self(),
+    {'EXIT', {{boom, _}, _}} =
+        (catch parallel_fold(Ref, fun({<<1:32>>, _V}, _Acc) -> erlang:error(boom);
+                                     (_KV, Acc) -> Self ! {shard, self()},
+                                                   receive after infinity -> Acc end
+                                  end, 0, [], 4)),
+    Stuck = [receive {shard, Pid} -> Pid after 0 -> none end || _ <- Shards],
+    false = lists:any(fun erlang:is_process_alive/1, [Pid || Pid <- Stuck, Pid =/= none]),
+    ok = close(Ref).
+
+prefetch_test() -> [{prefetch_test_Z(), l} || l <- lists:seq(1, 20)].
+prefetch_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.prefetch.test"),
+    {ok, Ref} = open("/tmp/erocksdb.prefetch.test", [{create_if_missing, true}], []),
+    [ok = put(Ref, <<N:32>>, <<N:32>>, []) || N <- lists:seq(1, 100)],
+    {ok, Itr} = iterator(Ref, [], keys_only),
+    {ok, <<1:32>>} = iterator_move(Itr, first),
+    %% long runs of next switch the iterator to prefetching
+    [{ok, <<N:32>>} = iterator_move(Itr, next) || N <- lists:seq(2, 50)],
+    %% other moves start from the entry last returned, not the prefetched one
+    {ok, <<49:32>>} = iterator_move(Itr, prev),
+    [{ok, <<N:32>>} = iterator_move(Itr, next) || N <- lists:seq(50, 60)],
+    {ok, [<<61:32>>, <<62:32>>]} = iterator_move(Itr, {next, 2}),
+    [{ok, <<N:32>>} = iterator_move(Itr, next) || N <- lists:seq(63, 100)],
+    {error, invalid_iterator} = iterator_move(Itr, next),
+    {ok, <<10:32>>} = iterator_move(Itr, <<10:32>>),
+    [{ok, <<N:32>>} = iterator_move(Itr, next) || N <- lists:seq(11, 20)],
+    {ok, <<100:32>>} = iterator_move(Itr, last),
+    ok = iterator_close(Itr),
+    ok = close(Ref).
+
+iterate_bounds_test() -> [{iterate_bounds_test_Z(), l} || l <- lists:seq(1, 20)].
+iterate_bounds_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.iterate_bounds.test"),
+    {ok, Ref} = open("/tmp/erocksdb.iterate_bounds.test", [{create_if_missing, true}], []),
+    [ok = put(Ref, <<N:32>>, <<N:32>>, []) || N <- lists:seq(1, 10)],
+    Bounds = [{iterate_lower_bound, <<3:32>>}, {iterate_upper_bound, <<8:32>>}],
+    {ok, Itr} = iterator(Ref, Bounds, keys_only),
+    {ok, <<3:32>>} = iterator_move(Itr, first),
+    {ok, <<7:32>>} = iterator_move(Itr, last),
+    {ok, <<6:32>>} = iterator_move(Itr, prev),
+    {ok, <<3:32>>} = iterator_move(Itr, <<1:32>>),
+    {error, invalid_iterator} = iterator_move(Itr, prev),
+    {error, invalid_iterator} = iterator_move(Itr, <<9:32>>),
+    {ok, <<6:32>>} = iterator_move(Itr, <<6:32>>),
+    {ok, [<<7:32>>]} = iterator_move(Itr, {next, 5}),
+    ok = iterator_close(Itr),
+    %% bounds survive the handle they were parsed from
+    {ok, ReadOpts} = read_options(Bounds),
+    {ok, HandleItr} = iterator(Ref, ReadOpts, keys_only),
+    {ok, <<3:32>>} = iterator_move(HandleItr, first),
+    {ok, [<<4:32>>, <<5:32>>, <<6:32>>, <<7:32>>]} = iterator_move(HandleItr, {next, 10}),
+    ok = iterator_close(HandleItr),
+    [<<N:32>> || N <- lists:seq(3, 7)] =
+        lists:reverse(fold_keys(Ref, fun(K, Acc) -> [K | Acc] end, [], Bounds)),
+    %% upper bound past every key, and below every key
+    {ok, PastItr} = iterator(Ref, [{iterate_upper_bound, <<100:32>>}], keys_only),
+    {ok, <<10:32>>} = iterator_move(PastItr, last),
+    ok = iterator_close(PastItr),
+    {ok, BelowItr} = iterator(Ref, [{iterate_upper_bound, <<1:32>>}], keys_only),
+    {error, invalid_iterator} = iterator_move(BelowItr, last),
+    ok = iterator_close(BelowItr),
+    ok = close(Ref).
+
+options_handle_test() -> [{options_handle_test_Z(), l} || l <- lists:seq(1, 20)].
+options_handle_test_Z() ->
+    os:cmd("rm -rf /tmp/erocksdb.options_handle.test"),
+    {ok, Ref} = open("/tmp/erocksdb.options_handle.test", [{create_if_missing, true}], []),
+    {ok, ReadOpts} = read_options([{fill_cache, false}]),
+    {ok, WriteOpts} = write_options([{sync, true}]),
+    ok = put(Ref, <<"a">>, <<"1">>, WriteOpts),
+    ok = write(Ref, [{put, <<"b">>, <<"2">>}], WriteOpts),
+    {ok, <<"1">>} = ?MODULE:get(Ref, <<"a">>, ReadOpts),
+    [{ok, <<"1">>}, {ok, <<"2">>}] = multi_get(Ref, [<<"a">>, <<"b">>], ReadOpts),
+    [{<<"a">>, <<"1">>}, {<<"b">>, <<"2">>}] =
+        lists:reverse(fold(Ref, fun(KV, Acc) -> [KV | Acc] end, [], ReadOpts)),
+    %% handles of one kind are not accepted for the other
+    {'EXIT', {badarg, _}} = (catch put(Ref, <<"c">>, <<"3">>, ReadOpts)),
+    {'EXIT', {badarg, _}} = (catch read_options(not_a_list)),
+    ok = close(Ref).
+
 fold_test() -> [{fold_test_Z(), l} || l <- lists:seq(1, 20)].
 fold_test_Z() ->
     os:cmd("rm -rf /tmp/erocksdb.fold.test"),